@@ -0,0 +1,287 @@
+#include "allocator.h"
+#include "logger.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// Every allocation is aligned to this, enough for any type a vector may hold.
+#define ALLOCATOR_ALIGN 16
+
+static size_t align_up(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+struct ArenaAllocatorBlock {
+    ArenaAllocatorBlock *next;
+    size_t size;
+    size_t used;
+    _Alignas(ALLOCATOR_ALIGN) char data[];
+};
+
+static void *arena_alloc(size_t size, void *context)
+{
+    ArenaAllocator *arena = (ArenaAllocator *) context;
+    ArenaAllocatorBlock *block = arena->blocks;
+    size = align_up(size ? size : 1, ALLOCATOR_ALIGN);
+
+    if (!block || block->used + size > block->size) {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        block = (ArenaAllocatorBlock *) malloc(sizeof(ArenaAllocatorBlock) + block_size);
+        if (!block) {
+            LOG_ERROR("There was an error while allocating a block of: %li bytes for arena: %p.", block_size, context);
+            return NULL;
+        }
+
+        LOG_INFO("Allocated a block of: %li bytes for arena: %p.", block_size, context);
+        block->size = block_size;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    arena->last = block->data + block->used;
+    block->used += size;
+    return arena->last;
+}
+
+static void *arena_realloc(void *data, size_t old_size, size_t size, void *context)
+{
+    ArenaAllocator *arena = (ArenaAllocator *) context;
+    if (!data)
+        return arena_alloc(size, context);
+
+    // The last allocation just moves the end of its block, as long as there is room in it.
+    ArenaAllocatorBlock *block = arena->blocks;
+    if (data == arena->last) {
+        size_t start = arena->last - block->data;
+        size_t end = start + align_up(size ? size : 1, ALLOCATOR_ALIGN);
+        if (end <= block->size) {
+            block->used = end;
+            return data;
+        }
+    } else if (size <= old_size) {
+        return data;
+    }
+
+    void *moved = arena_alloc(size, context);
+    if (moved)
+        memcpy(moved, data, old_size < size ? old_size : size);
+    return moved;
+}
+
+static void arena_free_memory(void *data, size_t size, void *context)
+{
+    ArenaAllocator *arena = (ArenaAllocator *) context;
+    if (data && data == arena->last) {
+        arena->blocks->used = arena->last - arena->blocks->data;
+        arena->last = NULL;
+    }
+}
+
+bool arena_allocator_init(ArenaAllocator *arena, size_t block_size)
+{
+    if (block_size == (size_t) -1)
+        block_size = DEFAULT_ALLOCATOR_BLOCK_SIZE;
+
+    LOG_INFO("Initializing arena: %p with blocks of: %li bytes.", (void *) arena, block_size);
+
+    arena->allocator.alloc = arena_alloc;
+    arena->allocator.realloc = arena_realloc;
+    arena->allocator.free = arena_free_memory;
+    arena->allocator.context = arena;
+    arena->blocks = NULL;
+    arena->block_size = block_size;
+    arena->last = NULL;
+    return true;
+}
+
+void arena_allocator_reset(ArenaAllocator *arena)
+{
+    LOG_INFO("Resetting arena: %p.", (void *) arena);
+
+    // Keeps the newest block around for the next allocations, unless it's an oversized one.
+    ArenaAllocatorBlock *block = arena->blocks;
+    if (block && block->size == arena->block_size) {
+        arena->blocks = block->next;
+        block->next = NULL;
+        block->used = 0;
+    } else {
+        block = NULL;
+    }
+
+    arena_allocator_free(arena);
+    arena->blocks = block;
+}
+
+void arena_allocator_free(ArenaAllocator *arena)
+{
+    LOG_INFO("Freeing arena: %p.", (void *) arena);
+
+    while (arena->blocks) {
+        ArenaAllocatorBlock *next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    arena->last = NULL;
+}
+
+static void *pool_alloc(size_t size, void *context)
+{
+    PoolAllocator *pool = (PoolAllocator *) context;
+    if (size > pool->block_size) {
+        LOG_ERROR("Pool: %p only hands out blocks of up to: %li bytes, asked for: %li.", context, pool->block_size, size);
+        return NULL;
+    }
+
+    if (!pool->free_blocks) {
+        size_t header = align_up(sizeof(void *), ALLOCATOR_ALIGN);
+        char *chunk = (char *) malloc(header + pool->blocks_per_chunk * pool->block_size);
+        if (!chunk) {
+            LOG_ERROR("There was an error while allocating a chunk for pool: %p.", context);
+            return NULL;
+        }
+
+        *(void **) chunk = pool->chunks;
+        pool->chunks = chunk;
+
+        // Threads every block of the new chunk into the free list.
+        for (size_t i = pool->blocks_per_chunk; i > 0; --i) {
+            char *block = chunk + header + (i - 1) * pool->block_size;
+            *(void **) block = pool->free_blocks;
+            pool->free_blocks = block;
+        }
+    }
+
+    void *block = pool->free_blocks;
+    pool->free_blocks = *(void **) block;
+    return block;
+}
+
+static void *pool_realloc(void *data, size_t old_size, size_t size, void *context)
+{
+    if (!data)
+        return pool_alloc(size, context);
+
+    PoolAllocator *pool = (PoolAllocator *) context;
+    if (size > pool->block_size) {
+        LOG_ERROR("Pool: %p only hands out blocks of up to: %li bytes, asked for: %li.", context, pool->block_size, size);
+        return NULL;
+    }
+    return data;
+}
+
+static void pool_free_memory(void *data, size_t size, void *context)
+{
+    PoolAllocator *pool = (PoolAllocator *) context;
+    if (!data)
+        return;
+
+    *(void **) data = pool->free_blocks;
+    pool->free_blocks = data;
+}
+
+bool pool_allocator_init(PoolAllocator *pool, size_t block_size, size_t blocks_per_chunk)
+{
+    block_size = align_up(block_size < sizeof(void *) ? sizeof(void *) : block_size, ALLOCATOR_ALIGN);
+    if (blocks_per_chunk == (size_t) -1)
+        blocks_per_chunk = DEFAULT_ALLOCATOR_BLOCK_SIZE / block_size;
+    if (blocks_per_chunk == 0)
+        blocks_per_chunk = 1;
+
+    LOG_INFO("Initializing pool: %p with blocks of: %li bytes.", (void *) pool, block_size);
+
+    pool->allocator.alloc = pool_alloc;
+    pool->allocator.realloc = pool_realloc;
+    pool->allocator.free = pool_free_memory;
+    pool->allocator.context = pool;
+    pool->block_size = block_size;
+    pool->blocks_per_chunk = blocks_per_chunk;
+    pool->free_blocks = NULL;
+    pool->chunks = NULL;
+    return true;
+}
+
+void pool_allocator_free(PoolAllocator *pool)
+{
+    LOG_INFO("Freeing pool: %p.", (void *) pool);
+
+    while (pool->chunks) {
+        void *next = *(void **) pool->chunks;
+        free(pool->chunks);
+        pool->chunks = next;
+    }
+    pool->free_blocks = NULL;
+}
+
+// Allocations smaller than this aren't worth a huge page of their own.
+#define HUGE_PAGE_THRESHOLD (HUGE_PAGE_SIZE / 2)
+
+static void *huge_page_alloc(size_t size, void *context)
+{
+    if (size < HUGE_PAGE_THRESHOLD)
+        return malloc(size);
+
+    size_t length = align_up(size, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+    void *data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED)
+        return data;
+#endif
+
+    /* No reserved huge pages left: map one huge page more than needed and trim it down to a range aligned
+     * to a huge page, so transparent huge pages can back all of it. */
+    char *mapped = (char *) mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("There was an error while mapping: %li bytes.", length);
+        return NULL;
+    }
+
+    char *aligned = (char *) align_up((uintptr_t) mapped, HUGE_PAGE_SIZE);
+    if (aligned > mapped)
+        munmap(mapped, aligned - mapped);
+    munmap(aligned + length, mapped + HUGE_PAGE_SIZE - aligned);
+
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+static void huge_page_free(void *data, size_t size, void *context)
+{
+    if (!data)
+        return;
+
+    if (size < HUGE_PAGE_THRESHOLD)
+        free(data);
+    else
+        munmap(data, align_up(size, HUGE_PAGE_SIZE));
+}
+
+static void *huge_page_realloc(void *data, size_t old_size, size_t size, void *context)
+{
+    if (!data)
+        return huge_page_alloc(size, context);
+    if (old_size < HUGE_PAGE_THRESHOLD && size < HUGE_PAGE_THRESHOLD)
+        return realloc(data, size);
+    if (old_size >= HUGE_PAGE_THRESHOLD && size >= HUGE_PAGE_THRESHOLD
+            && align_up(old_size, HUGE_PAGE_SIZE) == align_up(size, HUGE_PAGE_SIZE))
+        return data;
+
+    void *moved = huge_page_alloc(size, context);
+    if (!moved)
+        return NULL;
+
+    memcpy(moved, data, old_size < size ? old_size : size);
+    huge_page_free(data, old_size, context);
+    return moved;
+}
+
+const VectorAllocator huge_page_allocator = {
+    .alloc = huge_page_alloc,
+    .realloc = huge_page_realloc,
+    .free = huge_page_free,
+    .context = NULL
+};
@@ -0,0 +1,111 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include "vector_stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Where a vector gets its memory from, see int_vector_set_allocator(). Vectors without an allocator use
+ * malloc(), realloc() and free(). Sizes are in bytes, and old_size and size are always the sizes the memory
+ * was asked for with, so allocators don't need to keep them. realloc must keep the first old_size bytes
+ * when it moves memory, and all three functions must return NULL when they can't get memory. */
+typedef struct VectorAllocator {
+    void *(*alloc)(size_t size, void *context);
+    void *(*realloc)(void *data, size_t old_size, size_t size, void *context);
+    void (*free)(void *data, size_t size, void *context);
+    void *context;
+} VectorAllocator;
+
+/* Wrappers every vector allocates through, falling back to malloc() without an allocator.
+ * They count what they do into the global statistics and into stats when it isn't NULL. */
+static inline void *vector_alloc(const VectorAllocator *allocator, VectorStats *stats, size_t size)
+{
+    void *data = allocator ? allocator->alloc(size, allocator->context) : malloc(size);
+    if (data) {
+        VECTOR_STATS_ADD(stats, allocations, 1);
+        VECTOR_STATS_ADD(stats, bytes_allocated, size);
+        VECTOR_STATS_MAX(stats, peak_capacity, size);
+    }
+    return data;
+}
+
+static inline void *vector_realloc(const VectorAllocator *allocator, VectorStats *stats, void *data, size_t old_size, size_t size)
+{
+    // Compared once the old memory may already be gone, so only its address is kept.
+    uintptr_t old_data = (uintptr_t) data;
+    void *moved = allocator ? allocator->realloc(data, old_size, size, allocator->context) : realloc(data, size);
+    if (!moved)
+        return NULL;
+
+    // Reallocating NULL is the first allocation of a vector, whatever old_size says.
+    if (old_data) {
+        VECTOR_STATS_ADD(stats, reallocations, 1);
+        VECTOR_STATS_ADD(stats, bytes_freed, old_size);
+        if ((uintptr_t) moved != old_data)
+            VECTOR_STATS_ADD(stats, bytes_copied, old_size < size ? old_size : size);
+    } else {
+        VECTOR_STATS_ADD(stats, allocations, 1);
+    }
+    VECTOR_STATS_ADD(stats, bytes_allocated, size);
+    VECTOR_STATS_MAX(stats, peak_capacity, size);
+    return moved;
+}
+
+static inline void vector_free(const VectorAllocator *allocator, VectorStats *stats, void *data, size_t size)
+{
+    if (data) {
+        VECTOR_STATS_ADD(stats, frees, 1);
+        VECTOR_STATS_ADD(stats, bytes_freed, size);
+    }
+
+    if (allocator)
+        allocator->free(data, size, allocator->context);
+    else
+        free(data);
+}
+
+/* Bump allocator: memory is handed out back to back from big blocks and only given back all at once,
+ * by arena_allocator_reset() or arena_allocator_free(). Meant for vectors that live as long as a request.
+ * The last allocation made can still be grown or freed in place. */
+typedef struct ArenaAllocatorBlock ArenaAllocatorBlock;
+
+typedef struct {
+    VectorAllocator allocator;
+    ArenaAllocatorBlock *blocks;
+    size_t block_size;
+    // Last allocation made, the only one that can be grown in place.
+    char *last;
+} ArenaAllocator;
+
+// block_size of -1 means DEFAULT_ALLOCATOR_BLOCK_SIZE. Use &arena->allocator as the allocator of vectors.
+bool arena_allocator_init(ArenaAllocator *arena, size_t block_size);
+// Gives back every allocation at once. Vectors using the arena must not be used afterwards.
+void arena_allocator_reset(ArenaAllocator *arena);
+void arena_allocator_free(ArenaAllocator *arena);
+
+/* Allocator of fixed size blocks, kept in a free list. Meant for lots of small vectors that never grow
+ * past block_size bytes, asking for more fails. */
+typedef struct {
+    VectorAllocator allocator;
+    size_t block_size;
+    size_t blocks_per_chunk;
+    void *free_blocks;
+    // Chunks of blocks_per_chunk blocks, linked through their first bytes.
+    void *chunks;
+} PoolAllocator;
+
+// blocks_per_chunk of -1 means enough blocks to fill DEFAULT_ALLOCATOR_BLOCK_SIZE bytes.
+bool pool_allocator_init(PoolAllocator *pool, size_t block_size, size_t blocks_per_chunk);
+void pool_allocator_free(PoolAllocator *pool);
+
+/* Puts big allocations on 2 MB huge pages, reserved ones (MAP_HUGETLB) when the system has any free,
+ * otherwise transparent huge pages (MADV_HUGEPAGE). Smaller allocations are left to malloc(). */
+extern const VectorAllocator huge_page_allocator;
+
+#define DEFAULT_ALLOCATOR_BLOCK_SIZE (64 * 1024)
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#endif // ALLOCATOR_H
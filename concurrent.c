@@ -0,0 +1,201 @@
+#include "concurrent.h"
+#include "logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Slots are reserved before their segment is allocated, and a slot which is never written stops publication for good.
+ * So a failed allocation is retried this many times, a millisecond apart, before the push gives up. */
+#define CONCURRENT_ALLOCATION_ATTEMPTS 100
+
+// The written bitmap of a segment lives right after its numbers.
+static _Atomic(uint64_t) *segment_written(int *data, size_t segment)
+{
+    return (_Atomic(uint64_t) *) (data + segment_size(segment, CONCURRENT_FIRST_SEGMENT_BITS));
+}
+
+/* Returns segment, allocating it if no other thread did yet. When several threads race to allocate it,
+ * the first one to store it wins and the others free theirs. */
+static int *segment_get(ConcurrentIntVector *vector, size_t segment)
+{
+    int *data = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+    if (data)
+        return data;
+
+    size_t size = segment_size(segment, CONCURRENT_FIRST_SEGMENT_BITS);
+    int *allocated = (int *) calloc(1, size * sizeof(int) + size / 8);
+    for (size_t attempt = 1; !allocated && attempt < CONCURRENT_ALLOCATION_ATTEMPTS; ++attempt) {
+        // Another thread may have allocated it in the meantime.
+        data = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+        if (data)
+            return data;
+
+        nanosleep(&(struct timespec) { 0, 1000 * 1000 }, NULL);
+        allocated = (int *) calloc(1, size * sizeof(int) + size / 8);
+    }
+
+    if (!allocated) {
+        LOG_ERROR(
+            "There was an error while allocating segment: %li of vector: %p, numbers from then on won't be published.",
+            segment, (void *) vector
+        );
+        return NULL;
+    }
+
+    LOG_INFO("Allocated segment: %li with room for %li numbers in vector: %p.", segment, size, (void *) vector);
+
+    if (atomic_compare_exchange_strong_explicit(
+            &vector->segments[segment], &data, allocated, memory_order_acq_rel, memory_order_acquire))
+        return allocated;
+
+    free(allocated);
+    return data;
+}
+
+void int_vector_concurrent_init(ConcurrentIntVector *vector)
+{
+    LOG_INFO("Initializing concurrent vector: %p", (void *) vector);
+
+    for (size_t i = 0; i < CONCURRENT_SEGMENTS; ++i)
+        atomic_init(&vector->segments[i], NULL);
+    atomic_init(&vector->reserved, 0);
+    atomic_init(&vector->published, 0);
+}
+
+void int_vector_concurrent_free(ConcurrentIntVector *vector)
+{
+    LOG_INFO("Freeing concurrent vector: %p.", (void *) vector);
+
+    for (size_t i = 0; i < CONCURRENT_SEGMENTS; ++i) {
+        free(atomic_load_explicit(&vector->segments[i], memory_order_relaxed));
+        atomic_store_explicit(&vector->segments[i], NULL, memory_order_relaxed);
+    }
+    atomic_store_explicit(&vector->reserved, 0, memory_order_relaxed);
+    atomic_store_explicit(&vector->published, 0, memory_order_relaxed);
+}
+
+size_t int_vector_concurrent_push(ConcurrentIntVector *vector, int value)
+{
+    size_t index = atomic_fetch_add_explicit(&vector->reserved, 1, memory_order_relaxed);
+    size_t offset;
+    size_t segment = segment_of(index, CONCURRENT_FIRST_SEGMENT_BITS, &offset);
+
+    int *data = segment_get(vector, segment);
+    if (!data)
+        return -1;
+
+    data[offset] = value;
+    // Release: whoever sees the bit set also sees the number.
+    atomic_fetch_or_explicit(
+        &segment_written(data, segment)[offset / 64], (uint64_t) 1 << (offset % 64), memory_order_release
+    );
+    return index;
+}
+
+size_t int_vector_concurrent_push_array(ConcurrentIntVector *vector, const int array[], size_t array_size)
+{
+    size_t first = atomic_fetch_add_explicit(&vector->reserved, array_size, memory_order_relaxed);
+
+    // Fills the reserved range a bitmap word at a time, so a whole run of slots is marked written at once.
+    for (size_t done = 0; done < array_size;) {
+        size_t offset;
+        size_t segment = segment_of(first + done, CONCURRENT_FIRST_SEGMENT_BITS, &offset);
+        int *data = segment_get(vector, segment);
+        if (!data)
+            return -1;
+
+        size_t run = 64 - offset % 64;
+        if (run > array_size - done)
+            run = array_size - done;
+
+        memcpy(data + offset, array + done, run * sizeof(int));
+        uint64_t bits = (run == 64 ? ~(uint64_t) 0 : (((uint64_t) 1 << run) - 1)) << (offset % 64);
+        atomic_fetch_or_explicit(&segment_written(data, segment)[offset / 64], bits, memory_order_release);
+        done += run;
+    }
+    return first;
+}
+
+size_t int_vector_concurrent_publish(ConcurrentIntVector *vector)
+{
+    size_t published = atomic_load_explicit(&vector->published, memory_order_acquire);
+    size_t ready = published;
+
+    // Walks the written bitmaps a word at a time from the first unpublished slot, up to the first unwritten one.
+    for (;;) {
+        size_t offset;
+        size_t segment = segment_of(ready, CONCURRENT_FIRST_SEGMENT_BITS, &offset);
+        int *data = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+        if (!data)
+            break;
+
+        uint64_t word = atomic_load_explicit(&segment_written(data, segment)[offset / 64], memory_order_acquire);
+        uint64_t pending = ~(word >> (offset % 64));
+        if (pending == 0) {
+            ready += 64 - offset % 64;
+            continue;
+        }
+
+        size_t written = __builtin_ctzll(pending);
+        ready += written;
+        if (written < 64 - offset % 64)
+            break;
+    }
+
+    // Other threads may be publishing at the same time, only ever move published forward.
+    while (ready > published) {
+        if (atomic_compare_exchange_weak_explicit(
+                &vector->published, &published, ready, memory_order_release, memory_order_acquire))
+            return ready;
+    }
+    return published;
+}
+
+size_t int_vector_concurrent_size(const ConcurrentIntVector *vector)
+{
+    return atomic_load_explicit(&vector->published, memory_order_acquire);
+}
+
+const int *int_vector_concurrent_at(const ConcurrentIntVector *vector, size_t index)
+{
+    if (index >= int_vector_concurrent_size(vector)) {
+        LOG_ERROR("Index: %li isn't published yet.", index);
+        return NULL;
+    }
+
+    size_t offset;
+    size_t segment = segment_of(index, CONCURRENT_FIRST_SEGMENT_BITS, &offset);
+    return atomic_load_explicit(&vector->segments[segment], memory_order_acquire) + offset;
+}
+
+size_t int_vector_concurrent_snapshot(ConcurrentIntVector *vector, IntVector *dest)
+{
+    if (!dest->data) {
+        LOG_ERROR(
+            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
+            (void *) dest
+        );
+        return 0;
+    }
+
+    size_t size = int_vector_concurrent_publish(vector);
+    dest->offset = 0;
+    int_vector_reserve(dest, size);
+    if (dest->size < size)
+        return 0;
+
+    // Copies a whole segment at a time.
+    for (size_t segment = 0; dest->offset < size; ++segment) {
+        size_t count = segment_size(segment, CONCURRENT_FIRST_SEGMENT_BITS);
+        if (count > size - dest->offset)
+            count = size - dest->offset;
+
+        const int *data = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+        memcpy(dest->data + dest->offset, data, count * sizeof(int));
+        dest->offset += count;
+    }
+
+    LOG_INFO("Copied %li numbers of concurrent vector: %p to vector: %p.", size, (void *) vector, (void *) dest);
+    return size;
+}
@@ -0,0 +1,49 @@
+#ifndef CONCURRENT_H
+#define CONCURRENT_H
+
+#include "segment.h"
+#include "vector.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Segment 0 holds 1 << CONCURRENT_FIRST_SEGMENT_BITS numbers, see segment.h.
+#define CONCURRENT_FIRST_SEGMENT_BITS 10
+#define CONCURRENT_SEGMENTS SEGMENT_MAX_COUNT(CONCURRENT_FIRST_SEGMENT_BITS)
+
+/* Vector of ints any number of threads can push to at the same time without locks.
+ * Writers reserve a slot with an atomic increment and fill it, and segments are allocated by whichever
+ * writer needs them first. Segments never move, so growing never disturbs readers.
+ * Readers only see numbers once they are published: int_vector_concurrent_publish() makes visible every number
+ * up to the first slot whose writer hasn't finished yet. */
+typedef struct {
+    // Each segment is followed by a bitmap with one bit per slot, set once its number has been written.
+    _Atomic(int *) segments[CONCURRENT_SEGMENTS];
+    // Each counter has a cache line of its own, so writers bumping reserved don't slow down readers.
+    _Alignas(64) atomic_size_t reserved;
+    _Alignas(64) atomic_size_t published;
+} ConcurrentIntVector;
+
+void int_vector_concurrent_init(ConcurrentIntVector *vector);
+// Must not be called while other threads still use vector.
+void int_vector_concurrent_free(ConcurrentIntVector *vector);
+/* Returns the index value was stored at, or -1 if there is no memory left. A segment which still can't be allocated
+ * after a few retries leaves the slots reserved in it unwritten, which stops publication for good: no number pushed
+ * from then on, by any thread, ever becomes visible. The same goes for int_vector_concurrent_push_array(). */
+size_t int_vector_concurrent_push(ConcurrentIntVector *vector, int value);
+/* Reserves array_size slots in one go and copies array into them, returns the index of the first one or -1.
+ * Producers with numbers at hand should prefer it: threads then share the counters once per batch instead of
+ * once per number. */
+size_t int_vector_concurrent_push_array(ConcurrentIntVector *vector, const int array[], size_t array_size);
+// Publishes every number written so far with no unfinished slot before it. Returns how many numbers are published.
+size_t int_vector_concurrent_publish(ConcurrentIntVector *vector);
+// Returns how many numbers are published, all of them can be read with int_vector_concurrent_at().
+size_t int_vector_concurrent_size(const ConcurrentIntVector *vector);
+// Returns a pointer to the published number at index, or NULL if index isn't published yet.
+const int *int_vector_concurrent_at(const ConcurrentIntVector *vector, size_t index);
+/* Publishes what it can and replaces the contents of dest, an initialized vector, with a copy of the published
+ * numbers. Returns how many were copied. */
+size_t int_vector_concurrent_snapshot(ConcurrentIntVector *vector, IntVector *dest);
+
+#endif // CONCURRENT_H
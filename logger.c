@@ -1,8 +1,204 @@
 #include "logger.h"
 
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Messages are formatted by the calling thread and pushed into a bounded lock-free ring,
+ * a background thread drains the ring and does the actual writing. When the ring is full
+ * info and warning messages are dropped instead of blocking the caller, and the writer reports how many.
+ * Errors are never dropped, they are written by the calling thread instead. */
+#define LOG_RING_SIZE 1024 // Must be a power of two.
+#define LOG_MESSAGE_SIZE 256
+
+typedef struct {
+    atomic_size_t sequence;
+    enum LEVEL level;
+    char message[LOG_MESSAGE_SIZE];
+} LogCell;
+
+static LogCell ring[LOG_RING_SIZE];
+static atomic_size_t enqueue_pos;
+static atomic_size_t dequeue_pos;
+static atomic_size_t dropped;
+static atomic_bool writer_sleeping;
+static bool writer_running;
+
+static pthread_once_t writer_once = PTHREAD_ONCE_INIT;
+static pthread_t writer;
+static pthread_mutex_t writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t writer_drained = PTHREAD_COND_INITIALIZER;
+
+static _Thread_local char buffer[LOG_MESSAGE_SIZE];
+
+_Atomic int log_threshold = ERROR;
+
+void set_log_level(int level)
+{
+    atomic_store_explicit(&log_threshold, level, memory_order_relaxed);
+}
+
+static void write_message(enum LEVEL level, const char *message)
+{
+    FILE *stream = level == ERROR ? stderr : stdout;
+    fputs(message, stream);
+}
+
+static bool ring_push(enum LEVEL level, const char *message)
+{
+    size_t pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    LogCell *cell;
+
+    for (;;) {
+        cell = &ring[pos & (LOG_RING_SIZE - 1)];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        long diff = (long) sequence - (long) pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &enqueue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false; // Ring is full.
+        } else {
+            pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->level = level;
+    strcpy(cell->message, message);
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+// Only the writer thread pops, so there is no need to compete for dequeue_pos.
+static bool ring_pop(void)
+{
+    size_t pos = atomic_load_explicit(&dequeue_pos, memory_order_relaxed);
+    LogCell *cell = &ring[pos & (LOG_RING_SIZE - 1)];
+
+    if (atomic_load_explicit(&cell->sequence, memory_order_acquire) != pos + 1)
+        return false;
+
+    write_message(cell->level, cell->message);
+    atomic_store_explicit(&cell->sequence, pos + LOG_RING_SIZE, memory_order_release);
+    atomic_store_explicit(&dequeue_pos, pos + 1, memory_order_release);
+    return true;
+}
+
+static bool ring_is_empty(void)
+{
+    return atomic_load(&dequeue_pos) == atomic_load(&enqueue_pos);
+}
+
+static void *writer_loop(void *arg)
+{
+    size_t reported = 0;
+
+    for (;;) {
+        while (ring_pop())
+            ;
+
+        size_t lost = atomic_load_explicit(&dropped, memory_order_relaxed);
+        if (lost != reported) {
+            fprintf(stderr, "%s: %s(): %li messages were dropped.\n", get_log_level(WARN), __func__, lost - reported);
+            reported = lost;
+        }
+
+        fflush(stdout);
+        fflush(stderr);
+
+        pthread_mutex_lock(&writer_mutex);
+        pthread_cond_broadcast(&writer_drained);
+        atomic_store(&writer_sleeping, true);
+        if (ring_is_empty()) {
+            // The timeout is just a safety net, producers wake the writer up when it's sleeping.
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 100 * 1000 * 1000;
+            if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+                deadline.tv_nsec -= 1000 * 1000 * 1000;
+                ++deadline.tv_sec;
+            }
+            pthread_cond_timedwait(&writer_wakeup, &writer_mutex, &deadline);
+        }
+        atomic_store(&writer_sleeping, false);
+        pthread_mutex_unlock(&writer_mutex);
+    }
+
+    return NULL;
+}
+
+/* A forked child gets a copy of the ring but not the writer thread, and the writer may have held its mutex while
+ * forking. The child starts over with an empty ring and fresh locks, its writer is started by its first message.
+ * Messages still queued at fork time are left to the parent. */
+static void writer_reset_after_fork(void)
+{
+    atomic_store(&enqueue_pos, 0);
+    atomic_store(&dequeue_pos, 0);
+    atomic_store(&dropped, 0);
+    atomic_store(&writer_sleeping, false);
+    writer_running = false;
+    pthread_mutex_init(&writer_mutex, NULL);
+    pthread_cond_init(&writer_wakeup, NULL);
+    pthread_cond_init(&writer_drained, NULL);
+    writer_once = (pthread_once_t) PTHREAD_ONCE_INIT;
+}
+
+static void writer_start(void)
+{
+    // Both are inherited by forked children, so they are only registered by the first writer.
+    static bool registered;
+
+    for (size_t i = 0; i < LOG_RING_SIZE; ++i)
+        atomic_init(&ring[i].sequence, i);
+
+    writer_running = pthread_create(&writer, NULL, writer_loop, NULL) == 0;
+    if (!writer_running) {
+        fprintf(stderr, "%s: %s(): Couldn't start the writer thread, logging synchronously.\n", get_log_level(WARN), __func__);
+        return;
+    }
+
+    pthread_detach(writer);
+    if (!registered) {
+        registered = true;
+        pthread_atfork(NULL, NULL, writer_reset_after_fork);
+        atexit(logger_flush);
+    }
+}
+
+static void writer_wake(void)
+{
+    // Pairs with the writer setting writer_sleeping before checking whether the ring is empty.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_load(&writer_sleeping))
+        return;
+
+    pthread_mutex_lock(&writer_mutex);
+    pthread_cond_signal(&writer_wakeup);
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+void logger_flush(void)
+{
+    if (!writer_running)
+        return;
+
+    size_t target = atomic_load(&enqueue_pos);
+
+    pthread_mutex_lock(&writer_mutex);
+    while (atomic_load(&dequeue_pos) < target) {
+        pthread_cond_signal(&writer_wakeup);
+        pthread_cond_wait(&writer_drained, &writer_mutex);
+    }
+    pthread_mutex_unlock(&writer_mutex);
+}
 
 void logger(enum LEVEL level, bool log, const char *func_name, const char *format, ...)
 {
@@ -10,28 +206,45 @@ void logger(enum LEVEL level, bool log, const char *func_name, const char *forma
     if (!log)
         return;
 
-    const char *tmpfile = "/tmp/vector.log";
-    const size_t size = 255;
-    FILE *fp = fopen(tmpfile, "w+");
-    char *message = (char *) malloc(size * sizeof(char));
-    va_list args;
+    pthread_once(&writer_once, writer_start);
 
+    int prefix = snprintf(buffer, LOG_MESSAGE_SIZE, "%s: %s(): ", get_log_level(level), func_name);
+    if (prefix < 0 || prefix >= LOG_MESSAGE_SIZE - 1)
+        prefix = LOG_MESSAGE_SIZE - 2;
+
+    va_list args;
     va_start(args, format);
-    if (vfprintf(fp, format, args) < 0) {
+    int size = vsnprintf(buffer + prefix, LOG_MESSAGE_SIZE - prefix - 1, format, args);
+    va_end(args);
+
+    if (size < 0) {
         fprintf(stderr, "There was an error parsing arguments.\n");
         return;
     }
-    va_end(args);
 
-    fseek(fp, SEEK_SET, SEEK_SET);
-    message = fgets(message, size, fp);
+    // Messages longer than LOG_MESSAGE_SIZE are truncated, but always end with a new line.
+    size_t end = prefix + size;
+    if (end > LOG_MESSAGE_SIZE - 2)
+        end = LOG_MESSAGE_SIZE - 2;
+    buffer[end] = '\n';
+    buffer[end + 1] = '\0';
 
-    FILE *stream = level == ERROR ? stderr : stdout;
+    if (!writer_running) {
+        write_message(level, buffer);
+        return;
+    }
+
+    if (!ring_push(level, buffer)) {
+        // stderr is unbuffered and locked by every write, so errors can go straight to it, ahead of what's queued.
+        if (level == ERROR)
+            write_message(level, buffer);
+        else
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        writer_wake();
+        return;
+    }
 
-    fprintf(stream, "%s: %s(): %s\n", get_log_level(level), func_name, message);
-    free(message);
-    fclose(fp);
-    remove(tmpfile);
+    writer_wake();
 }
 
 const char *get_log_level(enum LEVEL level)
@@ -44,4 +257,5 @@ const char *get_log_level(enum LEVEL level)
     case ERROR:
         return "Error";
     }
+    return "Unknown";
 }
@@ -1,6 +1,7 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 
@@ -10,7 +11,32 @@ enum LEVEL {
     ERROR
 };
 
+/* Call sites below VECTOR_LOG_LEVEL are removed at compile time, arguments included.
+ * Build with -DVECTOR_LOG_LEVEL=ERROR for release, or with -DVECTOR_LOG_LEVEL=ERROR+1 to remove every call site. */
+#ifndef VECTOR_LOG_LEVEL
+#define VECTOR_LOG_LEVEL INFO
+#endif
+
+// Messages below this level are skipped at runtime, see set_log_level(). Atomic since any thread may log.
+extern _Atomic int log_threshold;
+
+#define LOG_ENABLED(level) \
+    ((level) >= (VECTOR_LOG_LEVEL) && (level) >= atomic_load_explicit(&log_threshold, memory_order_relaxed))
+#define LOG(level, ...) \
+    do { \
+        if (LOG_ENABLED(level)) \
+            logger(level, true, __func__, __VA_ARGS__); \
+    } while (0)
+#define LOG_INFO(...) LOG(INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG(WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG(ERROR, __VA_ARGS__)
+
 const char *get_log_level(enum LEVEL level);
+// Sets the lowest level logged at runtime. Errors are logged by default, ERROR + 1 turns logging off.
+void set_log_level(int level);
+/* Messages are written by a background thread, call logger_flush() to wait until every message
+ * logged so far has been written. It's called automatically at exit. */
 void logger(enum LEVEL level, bool do_log, const char *func_name, const char *format, ...);
+void logger_flush(void);
 
 #endif // LOG_H
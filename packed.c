@@ -0,0 +1,219 @@
+#include "packed.h"
+#include "logger.h"
+#include "simd.h"
+
+#include <string.h>
+
+static unsigned bits_needed(uint32_t value)
+{
+    return value ? 32 - __builtin_clz(value) : 0;
+}
+
+static uint32_t bits_mask(unsigned bits)
+{
+    return bits == 32 ? UINT32_MAX : ((uint32_t) 1 << bits) - 1;
+}
+
+void packed_int_vector_init(PackedIntVector *vector, enum PACKED_ENCODING encoding)
+{
+    LOG_INFO("Initializing packed vector: %p...", (void *) vector);
+
+    vector->encoding = encoding;
+    vector->size = 0;
+    packed_int_blocks_init(&vector->blocks, -1);
+    packed_int_words_init(&vector->words, -1);
+}
+
+void packed_int_vector_free(PackedIntVector *vector)
+{
+    LOG_INFO("Freeing packed vector: %p.", (void *) vector);
+
+    packed_int_blocks_free(&vector->blocks);
+    packed_int_words_free(&vector->words);
+    vector->size = 0;
+}
+
+// Packs PACKED_BLOCK_SIZE numbers of values into a new block, in the lane layout described in packed.h.
+static bool pack_block(PackedIntVector *vector, const int values[])
+{
+    uint32_t packed[PACKED_BLOCK_SIZE];
+    PackedIntBlock block = { 0, values[0], vector->words.offset / 4, 0 };
+
+    /* Differences are taken as unsigned numbers, so they wrap around instead of overflowing, and unpacking gets
+     * them back whatever the reference is. The smallest one as a signed number keeps nearly sorted blocks small. */
+    if (vector->encoding == PACKED_DELTA) {
+        int32_t min = INT32_MAX;
+        for (size_t i = 1; i < PACKED_BLOCK_SIZE; ++i) {
+            packed[i] = (uint32_t) values[i] - (uint32_t) values[i - 1];
+            min = (int32_t) packed[i] < min ? (int32_t) packed[i] : min;
+        }
+        block.reference = (uint32_t) min;
+        packed[0] = block.reference;
+    } else {
+        int min = values[0];
+        for (size_t i = 1; i < PACKED_BLOCK_SIZE; ++i)
+            min = values[i] < min ? values[i] : min;
+        block.reference = (uint32_t) min;
+        for (size_t i = 0; i < PACKED_BLOCK_SIZE; ++i)
+            packed[i] = (uint32_t) values[i];
+    }
+
+    uint32_t highest = 0;
+    for (size_t i = 0; i < PACKED_BLOCK_SIZE; ++i) {
+        packed[i] -= block.reference;
+        highest |= packed[i];
+    }
+    block.bits = bits_needed(highest);
+
+    uint32_t *words = packed_int_words_append_uninit(&vector->words, 4 * block.bits);
+    if (!words || !packed_int_blocks_extend(&vector->blocks, &block, 1)) {
+        LOG_ERROR("There was an error while packing a block of vector: %p.", (void *) vector);
+        if (words)
+            vector->words.offset -= 4 * block.bits;
+        return false;
+    }
+
+    memset(words, 0, 4 * block.bits * sizeof(uint32_t));
+    for (size_t i = 0; i < PACKED_BLOCK_SIZE && block.bits; ++i) {
+        size_t lane = i % 4;
+        size_t position = i / 4 * block.bits;
+        size_t word = position / 32;
+        size_t shift = position % 32;
+        words[word * 4 + lane] |= packed[i] << shift;
+        if (shift + block.bits > 32)
+            words[(word + 1) * 4 + lane] |= packed[i] >> (32 - shift);
+    }
+    return true;
+}
+
+bool packed_int_vector_add(PackedIntVector *vector, int value)
+{
+    vector->tail[vector->size % PACKED_BLOCK_SIZE] = value;
+    if ((vector->size + 1) % PACKED_BLOCK_SIZE == 0 && !pack_block(vector, vector->tail))
+        return false;
+
+    ++vector->size;
+    return true;
+}
+
+bool packed_int_vector_add_array(PackedIntVector *vector, const int array[], size_t array_size)
+{
+    size_t i = 0;
+
+    // Fills the tail up first, whole blocks of array are then packed straight from it.
+    while (i < array_size && vector->size % PACKED_BLOCK_SIZE != 0) {
+        if (!packed_int_vector_add(vector, array[i++]))
+            return false;
+    }
+
+    for (; i + PACKED_BLOCK_SIZE <= array_size; i += PACKED_BLOCK_SIZE) {
+        if (!pack_block(vector, array + i))
+            return false;
+        vector->size += PACKED_BLOCK_SIZE;
+    }
+
+    memcpy(vector->tail, array + i, (array_size - i) * sizeof(int));
+    vector->size += array_size - i;
+    return true;
+}
+
+size_t packed_int_vector_unpack_block(const PackedIntVector *vector, size_t block, int out[])
+{
+    if (block == vector->blocks.offset) {
+        size_t size = vector->size % PACKED_BLOCK_SIZE;
+        memcpy(out, vector->tail, size * sizeof(int));
+        return size;
+    }
+
+    if (block > vector->blocks.offset) {
+        LOG_ERROR("Block: %li is out of bound.", block);
+        return 0;
+    }
+
+    const PackedIntBlock *header = &vector->blocks.data[block];
+    simd_unpack(vector->words.data + (size_t) header->group * 4, header->bits, header->reference, (uint32_t *) out);
+    if (vector->encoding == PACKED_DELTA) {
+        out[0] = header->first;
+        simd_prefix_sum((uint32_t *) out, PACKED_BLOCK_SIZE);
+    }
+    return PACKED_BLOCK_SIZE;
+}
+
+int packed_int_vector_get_at(const PackedIntVector *vector, size_t index)
+{
+    if (index >= vector->size) {
+        LOG_ERROR("Index: %li is out of bound.", index);
+        return -1;
+    }
+
+    size_t block = index / PACKED_BLOCK_SIZE;
+    size_t i = index % PACKED_BLOCK_SIZE;
+    if (block == vector->blocks.offset)
+        return vector->tail[i];
+
+    // Numbers of delta blocks depend on every number before them, so the whole block is unpacked.
+    if (vector->encoding == PACKED_DELTA) {
+        int out[PACKED_BLOCK_SIZE];
+        packed_int_vector_unpack_block(vector, block, out);
+        return out[i];
+    }
+
+    const PackedIntBlock *header = &vector->blocks.data[block];
+    if (header->bits == 0)
+        return (int) header->reference;
+
+    const uint32_t *words = vector->words.data + (size_t) header->group * 4;
+    size_t lane = i % 4;
+    size_t position = i / 4 * header->bits;
+    size_t word = position / 32;
+    size_t shift = position % 32;
+    uint32_t value = words[word * 4 + lane] >> shift;
+    if (shift + header->bits > 32)
+        value |= words[(word + 1) * 4 + lane] << (32 - shift);
+    return (int) ((value & bits_mask(header->bits)) + header->reference);
+}
+
+long long packed_int_vector_sum(const PackedIntVector *vector)
+{
+    int out[PACKED_BLOCK_SIZE];
+    long long sum = 0;
+    for (size_t block = 0; block <= vector->blocks.offset; ++block) {
+        size_t size = packed_int_vector_unpack_block(vector, block, out);
+        sum += simd_sum(out, size);
+    }
+    return sum;
+}
+
+size_t packed_int_vector_memory(const PackedIntVector *vector)
+{
+    return vector->blocks.offset * sizeof(PackedIntBlock)
+        + vector->words.offset * sizeof(uint32_t)
+        + vector->size % PACKED_BLOCK_SIZE * sizeof(int);
+}
+
+bool packed_int_vector_pack(PackedIntVector *dest, const IntVector *source, enum PACKED_ENCODING encoding)
+{
+    packed_int_vector_init(dest, encoding);
+    return packed_int_vector_add_array(dest, source->data, source->offset);
+}
+
+bool packed_int_vector_unpack(const PackedIntVector *source, IntVector *dest)
+{
+    if (!dest->data) {
+        LOG_ERROR(
+            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
+            (void *) dest
+        );
+        return false;
+    }
+
+    dest->offset = 0;
+    int *out = int_vector_append_uninit(dest, source->size);
+    if (!out)
+        return false;
+
+    // Blocks are unpacked straight into dest, the tail included.
+    for (size_t block = 0; block <= source->blocks.offset; ++block)
+        packed_int_vector_unpack_block(source, block, out + block * PACKED_BLOCK_SIZE);
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Numbers are packed this many at a time, every block can be unpacked on its own.
+#define PACKED_BLOCK_SIZE 128
+
+enum PACKED_ENCODING {
+    // Every number is stored as its distance to the lowest number of its block.
+    PACKED_FOR,
+    /* Every number is stored as its distance to the previous one, minus the smallest such distance in its block.
+     * Meant for sorted numbers, e.g. IDs, whose distances are much smaller than the numbers themselves. */
+    PACKED_DELTA
+};
+
+/* Where a block starts, in groups of 4 words, and how to unpack it. With PACKED_DELTA, first is the first number
+ * of the block and reference the smallest distance, otherwise reference is the lowest number and first isn't used. */
+typedef struct {
+    uint32_t reference;
+    int first;
+    uint32_t group;
+    uint8_t bits;
+} PackedIntBlock;
+
+VECTOR_DEFINE(PackedIntBlocks, packed_int_blocks, PackedIntBlock)
+VECTOR_DEFINE(PackedIntWords, packed_int_words, uint32_t)
+
+/* Vector of ints packed with as few bits as each block of PACKED_BLOCK_SIZE numbers needs, sorted IDs and counters
+ * of small ranges take 4 to 8 times less memory than in an IntVector. A block of bits bits takes 4 * bits words:
+ * number i is number i / 4 of lane i % 4 and lane j is packed into words j, j + 4, j + 8..., so blocks unpack
+ * 4 numbers per SSE2 register, see simd_unpack(). Numbers are added to tail until it holds a whole block. */
+typedef struct {
+    enum PACKED_ENCODING encoding;
+    size_t size;
+    PackedIntBlocks blocks;
+    PackedIntWords words;
+    int tail[PACKED_BLOCK_SIZE];
+} PackedIntVector;
+
+void packed_int_vector_init(PackedIntVector *vector, enum PACKED_ENCODING encoding);
+void packed_int_vector_free(PackedIntVector *vector);
+// Both return false if there is no memory left, numbers added before that are kept.
+bool packed_int_vector_add(PackedIntVector *vector, int value);
+bool packed_int_vector_add_array(PackedIntVector *vector, const int array[], size_t array_size);
+// Returns the number at index, or -1 if index is out of bound. Only the words holding it are read.
+int packed_int_vector_get_at(const PackedIntVector *vector, size_t index);
+/* Unpacks block into out, which must have room for PACKED_BLOCK_SIZE numbers. The block after the last whole one
+ * is the tail. Returns how many numbers were written, 0 if block is out of bound. */
+size_t packed_int_vector_unpack_block(const PackedIntVector *vector, size_t block, int out[]);
+long long packed_int_vector_sum(const PackedIntVector *vector);
+// Bytes the packed numbers take, not counting spare capacity.
+size_t packed_int_vector_memory(const PackedIntVector *vector);
+// Initializes dest with the numbers of source.
+bool packed_int_vector_pack(PackedIntVector *dest, const IntVector *source, enum PACKED_ENCODING encoding);
+// Replaces the contents of dest, which must be an initialized vector, with the numbers of source.
+bool packed_int_vector_unpack(const PackedIntVector *source, IntVector *dest);
+
+#endif // PACKED_H
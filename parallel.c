@@ -0,0 +1,176 @@
+#include "vector.h"
+#include "logger.h"
+#include "thread_pool.h"
+
+// Chunks are never smaller than this many numbers, so each one is worth the bookkeeping of handing it out.
+#define PARALLEL_MIN_GRAIN 256
+// Every thread starts with about this many chunks, leaving room for the others to steal when one falls behind.
+#define PARALLEL_CHUNKS_PER_THREAD 8
+
+typedef struct {
+    IntVector *vector;
+    const int *source;
+    void (*for_each)(int *value, void *context);
+    int (*map)(int value, void *context);
+    int (*combine)(int a, int b, void *context);
+    void *context;
+    // One partial result per thread for reductions, each on a cache line of its own.
+    struct {
+        _Alignas(64) int value;
+    } *partials;
+    int value;
+} ParallelJob;
+
+static ThreadPool *parallel_pool(ThreadPool *pool)
+{
+    return pool ? pool : thread_pool_default();
+}
+
+static size_t parallel_grain(size_t size, ThreadPool *pool)
+{
+    size_t grain = size / (thread_pool_size(pool) * PARALLEL_CHUNKS_PER_THREAD);
+    if (grain < PARALLEL_MIN_GRAIN)
+        grain = PARALLEL_MIN_GRAIN;
+    return (grain + THREAD_POOL_SPLIT_ALIGN - 1) / THREAD_POOL_SPLIT_ALIGN * THREAD_POOL_SPLIT_ALIGN;
+}
+
+static bool check_initialized(const IntVector *vector)
+{
+    if (!vector->data) {
+        LOG_ERROR(
+            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
+            (void *) vector
+        );
+        return false;
+    }
+    return true;
+}
+
+static void for_each_task(size_t begin, size_t end, size_t worker, void *context)
+{
+    ParallelJob *job = (ParallelJob *) context;
+    for (size_t i = begin; i < end; ++i)
+        job->for_each(&job->vector->data[i], job->context);
+}
+
+void int_vector_parallel_for_each(IntVector *vector, void (*fn)(int *value, void *context), void *context, ThreadPool *pool)
+{
+    pool = parallel_pool(pool);
+    if (!pool)
+        return;
+
+    LOG_INFO("Running function on %li numbers of vector: %p in parallel...", vector->offset, (void *) vector);
+
+    ParallelJob job = { .vector = vector, .for_each = fn, .context = context };
+    thread_pool_run(pool, vector->offset, parallel_grain(vector->offset, pool), for_each_task, &job);
+}
+
+static void map_task(size_t begin, size_t end, size_t worker, void *context)
+{
+    ParallelJob *job = (ParallelJob *) context;
+    int *dest = job->vector->data;
+    for (size_t i = begin; i < end; ++i)
+        dest[i] = job->map(job->source[i], job->context);
+}
+
+/* Replaces the contents of dest with fn applied to every number of source. dest may be source itself,
+ * to map it in place. */
+void int_vector_parallel_map(
+    const IntVector *source,
+    IntVector *dest,
+    int (*fn)(int value, void *context),
+    void *context,
+    ThreadPool *pool)
+{
+    pool = parallel_pool(pool);
+    if (!pool || !check_initialized(dest))
+        return;
+
+    size_t size = source->offset;
+    LOG_INFO("Mapping %li numbers of vector: %p into vector: %p in parallel...", size, (void *) source, (void *) dest);
+
+    if (dest != source) {
+        dest->offset = 0;
+        int_vector_reserve(dest, size);
+        if (dest->size < size)
+            return;
+    }
+
+    ParallelJob job = { .vector = dest, .source = source->data, .map = fn, .context = context };
+    thread_pool_run(pool, size, parallel_grain(size, pool), map_task, &job);
+    dest->offset = size;
+}
+
+static void reduce_task(size_t begin, size_t end, size_t worker, void *context)
+{
+    ParallelJob *job = (ParallelJob *) context;
+    const int *data = job->vector->data;
+    int value = job->partials[worker].value;
+    for (size_t i = begin; i < end; ++i)
+        value = job->combine(value, data[i], job->context);
+    job->partials[worker].value = value;
+}
+
+/* Combines every number of vector starting from identity. Threads combine their chunks in whatever order they get them,
+ * so combine must be associative and commutative, e.g. a sum or a maximum. */
+int int_vector_parallel_reduce(
+    const IntVector *vector,
+    int identity,
+    int (*combine)(int a, int b, void *context),
+    void *context,
+    ThreadPool *pool)
+{
+    pool = parallel_pool(pool);
+    if (!pool)
+        return identity;
+
+    size_t threads = thread_pool_size(pool);
+    ParallelJob job = { .vector = (IntVector *) vector, .combine = combine, .context = context };
+    job.partials = aligned_alloc(64, threads * sizeof(*job.partials));
+    if (!job.partials) {
+        LOG_ERROR("There was an error while allocating memory to reduce vector: %p.", (void *) vector);
+        return identity;
+    }
+
+    LOG_INFO("Reducing %li numbers of vector: %p in parallel...", vector->offset, (void *) vector);
+
+    for (size_t i = 0; i < threads; ++i)
+        job.partials[i].value = identity;
+
+    thread_pool_run(pool, vector->offset, parallel_grain(vector->offset, pool), reduce_task, &job);
+
+    int value = identity;
+    for (size_t i = 0; i < threads; ++i)
+        value = combine(value, job.partials[i].value, context);
+
+    free(job.partials);
+    return value;
+}
+
+static void fill_task(size_t begin, size_t end, size_t worker, void *context)
+{
+    ParallelJob *job = (ParallelJob *) context;
+    int *data = job->vector->data;
+    for (size_t i = begin; i < end; ++i)
+        data[i] = job->value;
+}
+
+/* Replaces the contents of vector with size copies of value. Each thread writes its own part first,
+ * so on NUMA machines the memory ends up close to the threads that filled it. */
+void int_vector_parallel_fill(IntVector *vector, int value, size_t size, ThreadPool *pool)
+{
+    pool = parallel_pool(pool);
+    if (!pool || !check_initialized(vector))
+        return;
+
+    LOG_INFO("Filling vector: %p with %li copies of: %i in parallel...", (void *) vector, size, value);
+
+    vector->offset = 0;
+    int_vector_reserve(vector, size);
+    if (vector->size < size)
+        return;
+
+    ParallelJob job = { .vector = vector, .value = value };
+    thread_pool_run(pool, size, parallel_grain(size, pool), fill_task, &job);
+    vector->offset = size;
+}
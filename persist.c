@@ -0,0 +1,714 @@
+#include "vector.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Binary snapshots of IntVector: a header followed by the numbers as they are in memory, so opening one is
+ * just mapping it. Files are written in the byte order of the machine writing them, a file written by a machine
+ * with a different one is rejected because its version doesn't match. */
+#define INT_VECTOR_FILE_MAGIC "IVECTOR"
+#define INT_VECTOR_FILE_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t item_size;
+    uint64_t count;
+    uint64_t checksum;
+} IntVectorFileHeader;
+
+/* Four independent multiply-mix lanes over 8 bytes at a time, so verifying a file runs at memory speed.
+ * Catches truncated and corrupted files, it isn't meant to resist tampering. */
+static uint64_t checksum(const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    uint64_t lanes[4] = { 0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull, 0x27d4eb2f165667c5ull };
+    const uint64_t prime = 0x100000001b3ull;
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            memcpy(&word, bytes + i + lane * 8, 8);
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+        }
+    }
+
+    uint64_t hash = size;
+    for (size_t lane = 0; lane < 4; ++lane)
+        hash = (hash ^ lanes[lane]) * prime;
+    for (; i < size; ++i)
+        hash = (hash ^ bytes[i]) * prime;
+    return hash ^ (hash >> 29);
+}
+
+// Writes all of size bytes, retrying after short writes.
+static bool write_all(int fd, const void *data, size_t size)
+{
+    const char *bytes = (const char *) data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+/* Saves the items of vector to path. The file is written next to path and then renamed over it,
+ * so processes which have the old file mapped keep seeing its old contents. */
+bool int_vector_save(const IntVector *vector, const char *path)
+{
+    LOG_INFO("Saving vector: %p to file: %s...", (void *) vector, path);
+
+    IntVectorFileHeader header = { .magic = INT_VECTOR_FILE_MAGIC, .version = INT_VECTOR_FILE_VERSION };
+    header.item_size = sizeof(int);
+    header.count = vector->offset;
+    header.checksum = checksum(vector->data, vector->offset * sizeof(int));
+
+    size_t path_size = strlen(path);
+    char *temp_path = (char *) malloc(path_size + sizeof(".tmp"));
+    if (!temp_path) {
+        LOG_ERROR("There was an error while allocating memory to save vector: %p.", (void *) vector);
+        return false;
+    }
+    memcpy(temp_path, path, path_size);
+    memcpy(temp_path + path_size, ".tmp", sizeof(".tmp"));
+
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Couldn't open file: %s: %s.", temp_path, strerror(errno));
+        free(temp_path);
+        return false;
+    }
+
+    bool saved = write_all(fd, &header, sizeof(header)) && write_all(fd, vector->data, vector->offset * sizeof(int));
+    if (!saved)
+        LOG_ERROR("There was an error while writing file: %s: %s.", temp_path, strerror(errno));
+
+    if (close(fd) != 0)
+        saved = false;
+    if (saved && rename(temp_path, path) != 0) {
+        LOG_ERROR("Couldn't rename file: %s to: %s: %s.", temp_path, path, strerror(errno));
+        saved = false;
+    }
+    if (!saved)
+        unlink(temp_path);
+
+    free(temp_path);
+    return saved;
+}
+
+static void int_vector_unmap(void *data, size_t size, void *context)
+{
+    munmap((char *) data - sizeof(IntVectorFileHeader), sizeof(IntVectorFileHeader) + size * sizeof(int));
+}
+
+// Returns the header of a mapped file of file_size bytes, or NULL if it isn't a valid IntVector file.
+static const IntVectorFileHeader *check_header(const void *file, size_t file_size, const char *path)
+{
+    const IntVectorFileHeader *header = (const IntVectorFileHeader *) file;
+    if (file_size < sizeof(IntVectorFileHeader) || memcmp(header->magic, INT_VECTOR_FILE_MAGIC, 8) != 0) {
+        LOG_ERROR("File: %s isn't a vector file.", path);
+        return NULL;
+    }
+
+    if (header->version != INT_VECTOR_FILE_VERSION || header->item_size != sizeof(int)) {
+        LOG_ERROR("File: %s was written by an incompatible version or machine.", path);
+        return NULL;
+    }
+
+    if (header->count != (file_size - sizeof(IntVectorFileHeader)) / sizeof(int)
+        || (file_size - sizeof(IntVectorFileHeader)) % sizeof(int) != 0) {
+        LOG_ERROR("File: %s is truncated or corrupted.", path);
+        return NULL;
+    }
+
+    return header;
+}
+
+// Maps the whole file at path, returns NULL on error.
+static void *map_file(const char *path, size_t *file_size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Couldn't open file: %s: %s.", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        LOG_ERROR("Couldn't get size of file: %s: %s.", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    *file_size = st.st_size;
+    // Private writable mapping: the vector may be sorted or changed in place without touching the file.
+    void *file = *file_size ? mmap(NULL, *file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (file == MAP_FAILED) {
+        LOG_ERROR("Couldn't map file: %s: %s.", path, *file_size ? strerror(errno) : "empty file");
+        return NULL;
+    }
+    return file;
+}
+
+/* Initializes vector with the numbers saved in path by int_vector_save(), without reading nor copying them:
+ * data points straight into a private mapping of the file. Adding beyond the saved numbers copies them
+ * to memory of the vector's own first. The checksum isn't verified, see int_vector_verify_file(). */
+bool int_vector_open_mmap(IntVector *vector, const char *path)
+{
+    LOG_INFO("Opening file: %s into vector: %p...", path, (void *) vector);
+
+    size_t file_size;
+    void *file = map_file(path, &file_size);
+    if (!file)
+        return false;
+
+    const IntVectorFileHeader *header = check_header(file, file_size, path);
+    if (!header) {
+        munmap(file, file_size);
+        return false;
+    }
+
+    if (header->count == 0) {
+        munmap(file, file_size);
+        int_vector_init(vector, -1);
+        return vector->data != NULL;
+    }
+
+    vector->data = (int *) ((char *) file + sizeof(IntVectorFileHeader));
+    vector->size = header->count;
+    vector->offset = header->count;
+    vector->release = int_vector_unmap;
+    vector->release_context = NULL;
+    vector->allocator = NULL;
+    vector->stats = NULL;
+    return true;
+}
+
+// Returns whether path is a valid IntVector file whose numbers match the checksum they were saved with.
+bool int_vector_verify_file(const char *path)
+{
+    size_t file_size;
+    void *file = map_file(path, &file_size);
+    if (!file)
+        return false;
+
+    const IntVectorFileHeader *header = check_header(file, file_size, path);
+    bool valid = header && header->checksum == checksum(header + 1, header->count * sizeof(int));
+    if (header && !valid)
+        LOG_ERROR("Checksum of file: %s doesn't match its contents.", path);
+
+    munmap(file, file_size);
+    return valid;
+}
+
+/* StringVector snapshots: a header, every string NUL terminated back to back (the blob), padding up to
+ * a multiple of 8 bytes and then count + 1 offsets, the last one being the size of the blob.
+ * Offsets go last so a writer doesn't need to know how many strings there are beforehand. */
+#define STRING_VECTOR_FILE_MAGIC "SVECTOR"
+#define STRING_VECTOR_FILE_VERSION 1
+#define WRITE_BUFFER_SIZE (1 << 20)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t offset_size;
+    uint64_t count;
+    uint64_t blob_size;
+} StringVectorFileHeader;
+
+static size_t offsets_position(size_t blob_size)
+{
+    return sizeof(StringVectorFileHeader) + ((blob_size + 7) & ~(size_t) 7);
+}
+
+static size_t string_vector_file_size(const StringVectorFileHeader *header)
+{
+    return offsets_position(header->blob_size) + (header->count + 1) * sizeof(size_t);
+}
+
+static bool writer_flush(StringVectorWriter *writer)
+{
+    if (!writer->failed && !write_all(writer->fd, writer->buffer, writer->buffered)) {
+        LOG_ERROR("There was an error while writing file: %s: %s.", writer->path, strerror(errno));
+        writer->failed = true;
+    }
+    writer->buffered = 0;
+    return !writer->failed;
+}
+
+// Small writes are gathered in the writer's buffer, big ones go straight to the file.
+static bool writer_write(StringVectorWriter *writer, const void *data, size_t size)
+{
+    if (writer->buffered + size > WRITE_BUFFER_SIZE && !writer_flush(writer))
+        return false;
+
+    if (size >= WRITE_BUFFER_SIZE) {
+        if (!write_all(writer->fd, data, size)) {
+            LOG_ERROR("There was an error while writing file: %s: %s.", writer->path, strerror(errno));
+            writer->failed = true;
+        }
+        return !writer->failed;
+    }
+
+    memcpy(writer->buffer + writer->buffered, data, size);
+    writer->buffered += size;
+    return true;
+}
+
+static void writer_free(StringVectorWriter *writer)
+{
+    free(writer->path);
+    free(writer->buffer);
+    free(writer->offsets);
+    writer->path = NULL;
+    writer->buffer = NULL;
+    writer->offsets = NULL;
+    writer->fd = -1;
+}
+
+bool string_vector_writer_open(StringVectorWriter *writer, const char *path)
+{
+    LOG_INFO("Opening writer: %p for file: %s...", (void *) writer, path);
+
+    size_t path_size = strlen(path);
+    writer->fd = -1;
+    writer->path = (char *) malloc(path_size + sizeof(".tmp"));
+    writer->buffer = (char *) malloc(WRITE_BUFFER_SIZE);
+    writer->offsets_size = DEFAULT_RESIZE_VALUE;
+    writer->offsets = (size_t *) malloc((writer->offsets_size + 1) * sizeof(size_t));
+    writer->buffered = 0;
+    writer->blob_size = 0;
+    writer->count = 0;
+    writer->failed = false;
+
+    if (!writer->path || !writer->buffer || !writer->offsets) {
+        LOG_ERROR("There was an error while allocating memory for writer: %p.", (void *) writer);
+        writer_free(writer);
+        writer->failed = true;
+        return false;
+    }
+    writer->offsets[0] = 0;
+
+    memcpy(writer->path, path, path_size);
+    memcpy(writer->path + path_size, ".tmp", sizeof(".tmp"));
+    writer->fd = open(writer->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) {
+        LOG_ERROR("Couldn't open file: %s: %s.", writer->path, strerror(errno));
+        writer_free(writer);
+        writer->failed = true;
+        return false;
+    }
+
+    // The header is written last, once the sizes are known.
+    StringVectorFileHeader header = { .magic = "" };
+    return writer_write(writer, &header, sizeof(header));
+}
+
+static bool writer_add(StringVectorWriter *writer, const char *value, size_t size)
+{
+    if (writer->failed)
+        return false;
+
+    if (writer->count == writer->offsets_size) {
+        size_t new_size = writer->offsets_size * GROWTH_FACTOR;
+        size_t *offsets = (size_t *) realloc(writer->offsets, (new_size + 1) * sizeof(size_t));
+        if (!offsets) {
+            LOG_ERROR("There was an error while reallocating offsets of writer: %p.", (void *) writer);
+            writer->failed = true;
+            return false;
+        }
+        writer->offsets = offsets;
+        writer->offsets_size = new_size;
+    }
+
+    if (!writer_write(writer, value, size + 1))
+        return false;
+
+    writer->blob_size += size + 1;
+    writer->offsets[++writer->count] = writer->blob_size;
+    return true;
+}
+
+bool string_vector_writer_add(StringVectorWriter *writer, const char *value)
+{
+    return writer_add(writer, value, strlen(value));
+}
+
+// Writes offsets and the header, then moves the file to its final path. The writer is freed either way.
+static bool writer_finish(StringVectorWriter *writer, const size_t *offsets, size_t count)
+{
+    if (writer->fd < 0)
+        return false;
+
+    StringVectorFileHeader header = { .magic = STRING_VECTOR_FILE_MAGIC, .version = STRING_VECTOR_FILE_VERSION };
+    header.offset_size = sizeof(size_t);
+    header.count = count;
+    header.blob_size = writer->blob_size;
+
+    static const char padding[8] = { 0 };
+    writer_write(writer, padding, offsets_position(writer->blob_size) - sizeof(header) - writer->blob_size);
+    writer_write(writer, offsets, (count + 1) * sizeof(size_t));
+    writer_flush(writer);
+
+    if (!writer->failed && pwrite(writer->fd, &header, sizeof(header), 0) != sizeof(header)) {
+        LOG_ERROR("There was an error while writing file: %s: %s.", writer->path, strerror(errno));
+        writer->failed = true;
+    }
+    if (close(writer->fd) != 0)
+        writer->failed = true;
+
+    // Drop ".tmp" to get the final path back.
+    size_t path_size = strlen(writer->path) - strlen(".tmp");
+    char *path = strndup(writer->path, path_size);
+    if (!writer->failed && (!path || rename(writer->path, path) != 0)) {
+        LOG_ERROR("Couldn't rename file: %s: %s.", writer->path, strerror(errno));
+        writer->failed = true;
+    }
+    if (writer->failed)
+        unlink(writer->path);
+
+    free(path);
+    writer_free(writer);
+    return !writer->failed;
+}
+
+bool string_vector_writer_close(StringVectorWriter *writer)
+{
+    LOG_INFO("Closing writer: %p with %li strings...", (void *) writer, writer->count);
+    return writer_finish(writer, writer->offsets, writer->count);
+}
+
+bool string_vector_save(const StringVector *vector, const char *path)
+{
+    LOG_INFO("Saving vector: %p to file: %s...", (void *) vector, path);
+
+    StringVectorWriter writer;
+    if (!string_vector_writer_open(&writer, path))
+        return false;
+
+    // Arena vectors already have the file layout in memory, so the whole arena goes in a single write.
+    if (vector->offsets) {
+        writer_write(&writer, vector->arena, vector->offsets[vector->offset]);
+        writer.blob_size = vector->offsets[vector->offset];
+        return writer_finish(&writer, vector->offsets, vector->offset);
+    }
+
+    for (size_t i = 0; i < vector->offset; ++i)
+        writer_add(&writer, string_vector_get_at(vector, i), string_vector_get_size(vector, i));
+    return string_vector_writer_close(&writer);
+}
+
+static void string_vector_unmap(void *context)
+{
+    munmap(context, string_vector_file_size((const StringVectorFileHeader *) context));
+}
+
+bool string_vector_open_mmap(StringVector *vector, const char *path)
+{
+    LOG_INFO("Opening file: %s into vector: %p...", path, (void *) vector);
+
+    size_t file_size;
+    char *file = (char *) map_file(path, &file_size);
+    if (!file)
+        return false;
+
+    const StringVectorFileHeader *header = (const StringVectorFileHeader *) file;
+    if (file_size < sizeof(StringVectorFileHeader) || memcmp(header->magic, STRING_VECTOR_FILE_MAGIC, 8) != 0) {
+        LOG_ERROR("File: %s isn't a vector file.", path);
+        munmap(file, file_size);
+        return false;
+    }
+
+    if (header->version != STRING_VECTOR_FILE_VERSION || header->offset_size != sizeof(size_t)) {
+        LOG_ERROR("File: %s was written by an incompatible version or machine.", path);
+        munmap(file, file_size);
+        return false;
+    }
+
+    size_t *offsets = (size_t *) (file + offsets_position(header->blob_size));
+    if (string_vector_file_size(header) != file_size || offsets[0] != 0 || offsets[header->count] != header->blob_size) {
+        LOG_ERROR("File: %s is truncated or corrupted.", path);
+        munmap(file, file_size);
+        return false;
+    }
+
+    // Offsets are needed for any lookup, so ask for them to be read ahead. Strings are read when used.
+    size_t offsets_start = offsets_position(header->blob_size) & ~(size_t) (sysconf(_SC_PAGESIZE) - 1);
+    madvise(file + offsets_start, file_size - offsets_start, MADV_WILLNEED);
+
+    /* Offsets are checked in full since they're read anyway, strings aren't, to keep them unread until used.
+     * Every string takes at least its '\0', and the last byte being one keeps reads of any string inside the blob. */
+    const char *blob = file + sizeof(StringVectorFileHeader);
+    bool valid = header->count == 0 || blob[header->blob_size - 1] == '\0';
+    for (size_t i = 0; valid && i < header->count; ++i)
+        valid = offsets[i] < offsets[i + 1];
+
+    if (!valid) {
+        LOG_ERROR("File: %s is corrupted, its offsets don't match its strings.", path);
+        munmap(file, file_size);
+        return false;
+    }
+
+    vector->vector_size = header->count;
+    vector->offset = header->count;
+    vector->actual_sizes = NULL;
+    vector->items = NULL;
+    vector->arena = file + sizeof(StringVectorFileHeader);
+    vector->arena_size = header->blob_size;
+    vector->offsets = offsets;
+    vector->index = NULL;
+    vector->release = string_vector_unmap;
+    vector->release_context = file;
+    vector->allocator = NULL;
+    vector->stats = NULL;
+    return true;
+}
+
+/* Text export and import. Numbers are formatted two digits at a time from a table and written through a big buffer,
+ * and read back a buffer at a time, finding where each number ends 16 bytes at a time with SSE2. */
+#define TEXT_BUFFER_SIZE WRITE_BUFFER_SIZE
+// Longest run of characters read as one number, a sign and digits, leading zeros included.
+#define TEXT_MAX_NUMBER_SIZE 64
+// Numbers int_vector_read_text() reserves room for at a time.
+#define TEXT_NUMBERS_PER_RESERVE 4096
+
+static const char digit_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes the digits of value right before end and returns where they start.
+static char *format_int(int value, char *end)
+{
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t) value : (uint32_t) value;
+    char *start = end;
+    while (magnitude >= 100) {
+        start -= 2;
+        memcpy(start, digit_pairs + magnitude % 100 * 2, 2);
+        magnitude /= 100;
+    }
+    if (magnitude >= 10) {
+        start -= 2;
+        memcpy(start, digit_pairs + magnitude * 2, 2);
+    } else {
+        *--start = (char) ('0' + magnitude);
+    }
+    if (value < 0)
+        *--start = '-';
+    return start;
+}
+
+/* Writes the numbers of vector to fd as text, separated by separator and followed by a newline.
+ * Nothing is written for an empty vector. */
+bool int_vector_write_text(const IntVector *vector, int fd, const char *separator)
+{
+    LOG_INFO("Writing vector: %p as text to file descriptor: %i...", (void *) vector, fd);
+
+    size_t separator_size = strlen(separator);
+    if (separator_size > TEXT_BUFFER_SIZE / 2) {
+        LOG_ERROR("Separator of: %li characters is too long.", separator_size);
+        return false;
+    }
+
+    char *buffer = (char *) malloc(TEXT_BUFFER_SIZE);
+    if (!buffer) {
+        LOG_ERROR("There was an error while allocating a buffer to write vector: %p.", (void *) vector);
+        return false;
+    }
+
+    size_t buffered = 0;
+    bool written = true;
+    for (size_t i = 0; i < vector->offset && written; ++i) {
+        // A number takes at most 11 characters, plus what follows it: the separator, or the final newline.
+        if (buffered + 11 + (separator_size > 1 ? separator_size : 1) > TEXT_BUFFER_SIZE) {
+            written = write_all(fd, buffer, buffered);
+            buffered = 0;
+        }
+
+        char digits[11];
+        char *start = format_int(vector->data[i], digits + sizeof(digits));
+        memcpy(buffer + buffered, start, digits + sizeof(digits) - start);
+        buffered += digits + sizeof(digits) - start;
+
+        if (i + 1 < vector->offset) {
+            memcpy(buffer + buffered, separator, separator_size);
+            buffered += separator_size;
+        } else {
+            buffer[buffered++] = '\n';
+        }
+    }
+
+    written = written && write_all(fd, buffer, buffered);
+    free(buffer);
+
+    if (!written)
+        LOG_ERROR("There was an error while writing vector: %p to file descriptor: %i.", (void *) vector, fd);
+    return written;
+}
+
+// Returns how many digits text starts with. A non digit must follow them within the 16 bytes after the last one.
+static size_t digit_run(const char *text)
+{
+#ifdef __SSE2__
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    for (size_t run = 0;; run += 16) {
+        __m128i bytes = _mm_sub_epi8(_mm_loadu_si128((const __m128i *) (text + run)), zero);
+        // Digits are the bytes which are still at most 9 once '0' is taken away, as unsigned numbers.
+        __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(bytes, nine), bytes);
+        unsigned others = ~(unsigned) _mm_movemask_epi8(digits) & 0xFFFF;
+        if (others)
+            return run + __builtin_ctz(others);
+    }
+#else
+    size_t run = 0;
+    while (text[run] >= '0' && text[run] <= '9')
+        ++run;
+    return run;
+#endif
+}
+
+/* Reads the numbers in text[0, size) into vector, text must be followed by 16 readable bytes which aren't digits.
+ * Unless last is set, a number reaching the end of text may go on in the next read, so it's left for then.
+ * Stores in consumed where reading stopped. Returns false on a number which doesn't fit an int,
+ * or if there is no memory left. */
+static bool parse_numbers(IntVector *vector, const char *text, size_t size, bool last, size_t *consumed)
+{
+    size_t start = vector->offset;
+    size_t count = 0;
+    size_t room = 0;
+    size_t i = 0;
+    bool parsed = true;
+    for (;;) {
+        while (i < size && text[i] != '-' && (text[i] < '0' || text[i] > '9'))
+            ++i;
+        if (i == size)
+            break;
+
+        size_t token = i;
+        bool negative = text[i] == '-';
+        i += negative;
+        size_t digits = digit_run(text + i);
+        if (i + digits >= size && !last) {
+            i = token;
+            break;
+        }
+
+        // A '-' without digits after it is just one more separator.
+        if (digits == 0)
+            continue;
+
+        const char *number = text + i;
+        i += digits;
+        while (digits > 10 && *number == '0') {
+            ++number;
+            --digits;
+        }
+
+        uint64_t magnitude = 0;
+        for (size_t j = 0; j < digits && j < 11; ++j)
+            magnitude = magnitude * 10 + (number[j] - '0');
+
+        if (digits > 10 || magnitude > (uint64_t) INT32_MAX + negative) {
+            LOG_ERROR("Text: %.*s isn't a number which fits an int.", (int) (i - token), text + token);
+            i = token;
+            parsed = false;
+            break;
+        }
+
+        // Room is reserved as numbers are found, so the vector grows by what the text actually holds.
+        if (count == room) {
+            vector->offset = start + count;
+            if (!int_vector_append_uninit(vector, TEXT_NUMBERS_PER_RESERVE)) {
+                i = token;
+                parsed = false;
+                break;
+            }
+            room += TEXT_NUMBERS_PER_RESERVE;
+        }
+        vector->data[start + count++] = negative ? (int) (0u - (uint32_t) magnitude) : (int) magnitude;
+    }
+
+    vector->offset = start + count;
+    *consumed = i;
+    return parsed;
+}
+
+/* Appends the numbers written as text in fd to vector, until the end of the file. Numbers are optionally signed
+ * decimal integers, anything else between them is taken as separators, a '-' not followed by a digit included.
+ * Besides read and memory errors, only numbers which don't fit an int are errors. Numbers read before one are kept. */
+bool int_vector_read_text(IntVector *vector, int fd)
+{
+    if (!vector->data) {
+        LOG_ERROR(
+            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
+            (void *) vector
+        );
+        return false;
+    }
+
+    LOG_INFO("Reading numbers as text from file descriptor: %i into vector: %p...", fd, (void *) vector);
+
+    // 16 bytes of padding after the text, so digit_run() never loads past the buffer.
+    char *buffer = (char *) malloc(TEXT_BUFFER_SIZE + 16);
+    if (!buffer) {
+        LOG_ERROR("There was an error while allocating a buffer to read into vector: %p.", (void *) vector);
+        return false;
+    }
+
+    size_t kept = 0;
+    bool last = false;
+    bool parsed = true;
+    while (parsed && !last) {
+        ssize_t got = read(fd, buffer + kept, TEXT_BUFFER_SIZE - kept);
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("There was an error while reading from file descriptor: %i.", fd);
+            parsed = false;
+            break;
+        }
+
+        last = got == 0;
+        size_t size = kept + got;
+        memset(buffer + size, 0, 16);
+
+        size_t consumed;
+        parsed = parse_numbers(vector, buffer, size, last, &consumed);
+        if (!parsed)
+            break;
+
+        kept = size - consumed;
+        memmove(buffer, buffer + consumed, kept);
+        if (kept >= TEXT_MAX_NUMBER_SIZE) {
+            LOG_ERROR("Text: %.*s... is too long to be a number.", 16, buffer);
+            parsed = false;
+        }
+    }
+
+    free(buffer);
+    return parsed;
+}
@@ -0,0 +1,25 @@
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include <stddef.h>
+
+/* Math for vectors made of segments that never move: segment 0 holds 1 << first_bits items and every next
+ * segment holds twice as many as the previous one, so a handful of segments covers the whole address space
+ * and item i is found with a couple of shifts, no matter how many segments there are. */
+#define SEGMENT_MAX_COUNT(first_bits) (sizeof(size_t) * 8 - (first_bits))
+
+static inline size_t segment_size(size_t segment, unsigned first_bits)
+{
+    return (size_t) 1 << (segment + first_bits);
+}
+
+// Returns the segment item index lives in, and stores its position inside that segment in offset.
+static inline size_t segment_of(size_t index, unsigned first_bits, size_t *offset)
+{
+    size_t biased = index + ((size_t) 1 << first_bits);
+    unsigned top = sizeof(size_t) * 8 - 1 - __builtin_clzl(biased);
+    *offset = biased - ((size_t) 1 << top);
+    return top - first_bits;
+}
+
+#endif // SEGMENT_H
@@ -0,0 +1,140 @@
+#include "segmented.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+long long int_vector_segmented_sum(const SegmentedIntVector *vector)
+{
+    long long sum = 0;
+    int *data;
+    for (size_t segment = 0; segment < vector->segment_count; ++segment) {
+        size_t count = int_vector_segmented_segment(vector, segment, &data);
+        sum += simd_sum(data, count);
+    }
+    return sum;
+}
+
+struct SegmentedStringChunk {
+    SegmentedStringChunk *next;
+    size_t size;
+    size_t used;
+    char data[];
+};
+
+void string_vector_segmented_init(SegmentedStringVector *vector, size_t chunk_size)
+{
+    if (chunk_size == (size_t) -1)
+        chunk_size = SEGMENTED_STRING_CHUNK_SIZE;
+
+    segmented_strings_init(&vector->strings);
+    vector->chunks = NULL;
+    vector->chunk_size = chunk_size;
+}
+
+void string_vector_segmented_free(SegmentedStringVector *vector)
+{
+    segmented_strings_free(&vector->strings);
+    while (vector->chunks) {
+        SegmentedStringChunk *next = vector->chunks->next;
+        vector_free(NULL, NULL, vector->chunks, sizeof(SegmentedStringChunk) + vector->chunks->size);
+        vector->chunks = next;
+    }
+}
+
+// Returns room for size bytes in the newest chunk, starting a new chunk when it's full.
+static char *chunk_reserve(SegmentedStringVector *vector, size_t size)
+{
+    SegmentedStringChunk *chunk = vector->chunks;
+    if (chunk && chunk->used + size <= chunk->size) {
+        char *data = chunk->data + chunk->used;
+        chunk->used += size;
+        return data;
+    }
+
+    size_t chunk_size = size > vector->chunk_size ? size : vector->chunk_size;
+    chunk = (SegmentedStringChunk *) vector_alloc(NULL, NULL, sizeof(SegmentedStringChunk) + chunk_size);
+    if (!chunk) {
+        LOG_ERROR("There was an error while allocating a chunk of: %li bytes for vector: %p.", chunk_size, vector);
+        return NULL;
+    }
+
+    LOG_INFO("Allocated a chunk of: %li bytes for vector: %p.", chunk_size, vector);
+    chunk->size = chunk_size;
+    chunk->used = size;
+
+    // An oversized chunk is full already, so it goes behind the newest one to leave that one in use.
+    if (vector->chunks && chunk_size > vector->chunk_size) {
+        chunk->next = vector->chunks->next;
+        vector->chunks->next = chunk;
+    } else {
+        chunk->next = vector->chunks;
+        vector->chunks = chunk;
+    }
+    return chunk->data;
+}
+
+static bool add_string(SegmentedStringVector *vector, const char *value, size_t size)
+{
+    char *data = chunk_reserve(vector, size + 1);
+    if (!data)
+        return false;
+
+    memcpy(data, value, size + 1);
+    SegmentedString string = { data, size };
+    return segmented_strings_add(&vector->strings, string);
+}
+
+bool string_vector_segmented_add(SegmentedStringVector *vector, const char *value)
+{
+    VECTOR_STATS_ADD(NULL, strlen_calls, 1);
+    return add_string(vector, value, string_vector_strlen(value));
+}
+
+bool string_vector_segmented_add_array(SegmentedStringVector *vector, const char *values[], size_t count)
+{
+    if (!segmented_strings_reserve(&vector->strings, vector->strings.size + count))
+        return false;
+
+    VECTOR_STATS_ADD(NULL, strlen_calls, count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!add_string(vector, values[i], string_vector_strlen(values[i])))
+            return false;
+    }
+    return true;
+}
+
+size_t string_vector_segmented_size(const SegmentedStringVector *vector)
+{
+    return vector->strings.size;
+}
+
+char *string_vector_segmented_get_at(const SegmentedStringVector *vector, size_t index)
+{
+    SegmentedString *string = segmented_strings_at(&vector->strings, index);
+    return string ? string->value : NULL;
+}
+
+size_t string_vector_segmented_get_size(const SegmentedStringVector *vector, size_t index)
+{
+    SegmentedString *string = segmented_strings_at(&vector->strings, index);
+    return string ? string->size : (size_t) -1;
+}
+
+size_t string_vector_segmented_find(const SegmentedStringVector *vector, const char *value)
+{
+    size_t value_size = string_vector_strlen(value);
+    VECTOR_STATS_ADD(NULL, strlen_calls, 1);
+
+    size_t index = 0;
+    SegmentedString *strings;
+    for (size_t segment = 0; segment < vector->strings.segment_count; ++segment) {
+        size_t count = segmented_strings_segment(&vector->strings, segment, &strings);
+        for (size_t i = 0; i < count; ++i, ++index) {
+            if (strings[i].size == value_size && memcmp(strings[i].value, value, value_size) == 0)
+                return index;
+        }
+    }
+    return -1;
+}
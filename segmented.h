@@ -0,0 +1,171 @@
+#ifndef SEGMENTED_H
+#define SEGMENTED_H
+
+#include "allocator.h"
+#include "logger.h"
+#include "segment.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// Segment 0 holds 1 << SEGMENTED_FIRST_SEGMENT_BITS items, see segment.h.
+#define SEGMENTED_FIRST_SEGMENT_BITS 6
+#define SEGMENTED_SEGMENTS SEGMENT_MAX_COUNT(SEGMENTED_FIRST_SEGMENT_BITS)
+// Bytes of the chunks strings of a SegmentedStringVector are stored in, longer strings get a chunk of their own.
+#define SEGMENTED_STRING_CHUNK_SIZE (64 * 1024)
+
+/* Generates a vector of T made of segments of growing power of two sizes. Growing only allocates the next segment,
+ * so items never move: pointers to them stay valid until the vector is freed, and adding never stalls to copy
+ * the whole vector. Item i is found in O(1) through segment_of(). Every function is static inline. */
+#define SEGMENTED_VECTOR_DEFINE(name, prefix, T) \
+    typedef struct { \
+        T *segments[SEGMENTED_SEGMENTS]; \
+        size_t segment_count; \
+        size_t size; \
+    } name; \
+\
+static inline void prefix##_init(name *vector) \
+{ \
+    LOG_INFO("Initializing segmented vector: %p...", (void *) vector); \
+    memset(vector->segments, 0, sizeof(vector->segments)); \
+    vector->segment_count = 0; \
+    vector->size = 0; \
+} \
+\
+static inline void prefix##_free(name *vector) \
+{ \
+    LOG_INFO("Freeing segmented vector: %p.", (void *) vector); \
+    for (size_t i = 0; i < vector->segment_count; ++i) { \
+        vector_free(NULL, NULL, vector->segments[i], segment_size(i, SEGMENTED_FIRST_SEGMENT_BITS) * sizeof(T)); \
+        vector->segments[i] = NULL; \
+    } \
+    vector->segment_count = 0; \
+    vector->size = 0; \
+} \
+\
+/* Allocates segments until vector can hold size items. Returns false if there is no memory left. */ \
+static inline bool prefix##_reserve(name *vector, size_t size) \
+{ \
+    while (((((size_t) 1 << vector->segment_count) - 1) << SEGMENTED_FIRST_SEGMENT_BITS) < size) { \
+        size_t bytes = segment_size(vector->segment_count, SEGMENTED_FIRST_SEGMENT_BITS) * sizeof(T); \
+        T *segment = (T *) vector_alloc(NULL, NULL, bytes); \
+        if (!segment) { \
+            LOG_ERROR("There was an error while allocating a segment of: %li bytes.", bytes); \
+            return false; \
+        } \
+\
+        LOG_INFO("Allocated segment: %li of vector: %p.", vector->segment_count, (void *) vector); \
+        vector->segments[vector->segment_count++] = segment; \
+    } \
+    return true; \
+} \
+\
+static inline bool prefix##_add(name *vector, T value) \
+{ \
+    if (!prefix##_reserve(vector, vector->size + 1)) \
+        return false; \
+\
+    size_t offset; \
+    size_t segment = segment_of(vector->size, SEGMENTED_FIRST_SEGMENT_BITS, &offset); \
+    vector->segments[segment][offset] = value; \
+    ++vector->size; \
+    return true; \
+} \
+\
+/* Copies array in with one memcpy() per segment it spans. */ \
+static inline bool prefix##_add_array(name *vector, const T array[], size_t array_size) \
+{ \
+    if (!prefix##_reserve(vector, vector->size + array_size)) \
+        return false; \
+\
+    for (size_t done = 0; done < array_size;) { \
+        size_t offset; \
+        size_t segment = segment_of(vector->size, SEGMENTED_FIRST_SEGMENT_BITS, &offset); \
+        size_t count = segment_size(segment, SEGMENTED_FIRST_SEGMENT_BITS) - offset; \
+        if (count > array_size - done) \
+            count = array_size - done; \
+\
+        memcpy(vector->segments[segment] + offset, array + done, count * sizeof(T)); \
+        vector->size += count; \
+        done += count; \
+    } \
+    return true; \
+} \
+\
+/* Returns a pointer to the item at index, or NULL if index is out of bound. */ \
+static inline T *prefix##_at(const name *vector, size_t index) \
+{ \
+    if (index >= vector->size) { \
+        LOG_ERROR("Index: %li is out of bound.", index); \
+        return NULL; \
+    } \
+\
+    size_t offset; \
+    size_t segment = segment_of(index, SEGMENTED_FIRST_SEGMENT_BITS, &offset); \
+    return &vector->segments[segment][offset]; \
+} \
+\
+/* Removes the last item, storing it in value if not NULL. Segments are kept for the next items. */ \
+static inline bool prefix##_pop(name *vector, T *value) \
+{ \
+    if (vector->size == 0) { \
+        LOG_ERROR("Can't pop from empty vector: %p.", (void *) vector); \
+        return false; \
+    } \
+\
+    if (value) \
+        *value = *prefix##_at(vector, vector->size - 1); \
+    --vector->size; \
+    return true; \
+} \
+\
+/* Stores the items of segment in data and returns how many there are, so they can be walked a segment at a time. */ \
+static inline size_t prefix##_segment(const name *vector, size_t segment, T **data) \
+{ \
+    size_t first = (((size_t) 1 << segment) - 1) << SEGMENTED_FIRST_SEGMENT_BITS; \
+    if (segment >= vector->segment_count || first >= vector->size) { \
+        *data = NULL; \
+        return 0; \
+    } \
+\
+    size_t count = segment_size(segment, SEGMENTED_FIRST_SEGMENT_BITS); \
+    *data = vector->segments[segment]; \
+    return vector->size - first < count ? vector->size - first : count; \
+}
+
+SEGMENTED_VECTOR_DEFINE(SegmentedIntVector, int_vector_segmented, int)
+
+long long int_vector_segmented_sum(const SegmentedIntVector *vector);
+
+typedef struct {
+    char *value;
+    size_t size;
+} SegmentedString;
+
+SEGMENTED_VECTOR_DEFINE(SegmentedStrings, segmented_strings, SegmentedString)
+
+typedef struct SegmentedStringChunk SegmentedStringChunk;
+
+/* Vector of strings whose pointers, as returned by string_vector_segmented_get_at(), stay valid until it's freed.
+ * Strings are stored back to back in chunks that are never reallocated, a full chunk is just followed by a new one. */
+typedef struct {
+    SegmentedStrings strings;
+    // Newest chunk first, only that one gets new strings.
+    SegmentedStringChunk *chunks;
+    size_t chunk_size;
+} SegmentedStringVector;
+
+// chunk_size of -1 means SEGMENTED_STRING_CHUNK_SIZE.
+void string_vector_segmented_init(SegmentedStringVector *vector, size_t chunk_size);
+void string_vector_segmented_free(SegmentedStringVector *vector);
+bool string_vector_segmented_add(SegmentedStringVector *vector, const char *value);
+bool string_vector_segmented_add_array(SegmentedStringVector *vector, const char *values[], size_t count);
+size_t string_vector_segmented_size(const SegmentedStringVector *vector);
+// Returns the string at index, or NULL if index is out of bound.
+char *string_vector_segmented_get_at(const SegmentedStringVector *vector, size_t index);
+// Returns the length of the string at index, or -1 if index is out of bound.
+size_t string_vector_segmented_get_size(const SegmentedStringVector *vector, size_t index);
+// Returns the index of the first string equal to value, or -1 if there is none.
+size_t string_vector_segmented_find(const SegmentedStringVector *vector, const char *value);
+
+#endif // SEGMENTED_H
@@ -0,0 +1,802 @@
+#include "simd.h"
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#define TARGET(isa) __attribute__((target(isa)))
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+
+typedef struct {
+    long long (*sum)(const int *data, size_t size);
+    int (*min)(const int *data, size_t size);
+    int (*max)(const int *data, size_t size);
+    size_t (*count)(const int *data, size_t size, int value);
+    size_t (*find)(const int *data, size_t size, int value);
+    size_t (*skip_less)(const int *data, size_t size, int value);
+    size_t (*remove)(int *data, size_t size, int value);
+    void (*unpack)(const uint32_t *words, unsigned bits, uint32_t reference, uint32_t *out);
+    void (*prefix_sum)(uint32_t *data, size_t size);
+    size_t (*strlen)(const char *value);
+    size_t (*search)(const char *data, size_t size, const char *needle, size_t needle_size);
+} SimdKernels;
+
+static long long scalar_sum(const int *data, size_t size)
+{
+    long long sum = 0;
+    for (size_t i = 0; i < size; ++i)
+        sum += data[i];
+    return sum;
+}
+
+static int scalar_min(const int *data, size_t size)
+{
+    int min = INT_MAX;
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] < min)
+            min = data[i];
+    }
+    return min;
+}
+
+static int scalar_max(const int *data, size_t size)
+{
+    int max = INT_MIN;
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] > max)
+            max = data[i];
+    }
+    return max;
+}
+
+static size_t scalar_count(const int *data, size_t size, int value)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i)
+        count += data[i] == value;
+    return count;
+}
+
+static size_t scalar_find(const int *data, size_t size, int value)
+{
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == value)
+            return i;
+    }
+    return -1;
+}
+
+static size_t scalar_skip_less(const int *data, size_t size, int value)
+{
+    size_t i = 0;
+    while (i < size && data[i] < value)
+        ++i;
+    return i;
+}
+
+/* Copies the items of src other than value to dest, which may be src itself or any position before it.
+ * Items are always copied and the write position only moves past kept ones, so there is no branch to mispredict. */
+static size_t scalar_compact(int *dest, const int *src, size_t size, int value)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < size; ++i) {
+        int item = src[i];
+        dest[kept] = item;
+        kept += item != value;
+    }
+    return kept;
+}
+
+static size_t scalar_remove(int *data, size_t size, int value)
+{
+    return scalar_compact(data, data, size, value);
+}
+
+/* Numbers of a packed block are spread over 4 lanes: number i is number i / 4 of lane i % 4, and lane j packs its
+ * 32 numbers into words j, j + 4, j + 8..., bits bits each starting from the lowest ones. That way a register of
+ * 4 words unpacks to 4 consecutive numbers. */
+static void scalar_unpack(const uint32_t *words, unsigned bits, uint32_t reference, uint32_t *out)
+{
+    uint32_t mask = bits == 32 ? UINT32_MAX : ((uint32_t) 1 << bits) - 1;
+    for (size_t lane = 0; lane < 4; ++lane) {
+        size_t position = 0;
+        for (size_t k = 0; k < 32; ++k, position += bits) {
+            size_t word = position / 32;
+            size_t shift = position % 32;
+            uint32_t value = bits ? words[word * 4 + lane] >> shift : 0;
+            if (shift + bits > 32)
+                value |= words[(word + 1) * 4 + lane] << (32 - shift);
+            out[k * 4 + lane] = (value & mask) + reference;
+        }
+    }
+}
+
+static void scalar_prefix_sum(uint32_t *data, size_t size)
+{
+    for (size_t i = 1; i < size; ++i)
+        data[i] += data[i - 1];
+}
+
+static size_t scalar_strlen(const char *value)
+{
+    size_t size = 0;
+    while (value[size] != '\0')
+        ++size;
+    return size;
+}
+
+static size_t scalar_search(const char *data, size_t size, const char *needle, size_t needle_size)
+{
+    if (needle_size == 0)
+        return 0;
+
+    for (size_t i = 0; i + needle_size <= size; ++i) {
+        if (data[i] == needle[0] && memcmp(data + i, needle, needle_size) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static const SimdKernels scalar_kernels = {
+    scalar_sum, scalar_min, scalar_max, scalar_count, scalar_find, scalar_skip_less, scalar_remove,
+    scalar_unpack, scalar_prefix_sum, scalar_strlen, scalar_search
+};
+
+#ifdef SIMD_X86
+
+/* SSE2 has neither 32 to 64-bit sign extension nor 32-bit min/max, so both are done by hand.
+ * Sums are always accumulated in 64 bits so every level gives the exact same result. */
+TARGET("sse2") static long long sse2_sum(const int *data, size_t size)
+{
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+    }
+
+    long long lanes[2];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    return lanes[0] + lanes[1] + scalar_sum(data + i, size - i);
+}
+
+TARGET("sse2") static __m128i sse2_min_epi32(__m128i a, __m128i b)
+{
+    __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+}
+
+TARGET("sse2") static __m128i sse2_max_epi32(__m128i a, __m128i b)
+{
+    __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+
+TARGET("sse2") static int sse2_min(const int *data, size_t size)
+{
+    __m128i acc = _mm_set1_epi32(INT_MAX);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+        acc = sse2_min_epi32(acc, _mm_loadu_si128((const __m128i *) (data + i)));
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    int min = scalar_min(lanes, 4);
+    int tail = scalar_min(data + i, size - i);
+    return tail < min ? tail : min;
+}
+
+TARGET("sse2") static int sse2_max(const int *data, size_t size)
+{
+    __m128i acc = _mm_set1_epi32(INT_MIN);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+        acc = sse2_max_epi32(acc, _mm_loadu_si128((const __m128i *) (data + i)));
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    int max = scalar_max(lanes, 4);
+    int tail = scalar_max(data + i, size - i);
+    return tail > max ? tail : max;
+}
+
+TARGET("sse2") static size_t sse2_count(const int *data, size_t size, int value)
+{
+    __m128i needle = _mm_set1_epi32(value);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (data + i)), needle);
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+    }
+    return count + scalar_count(data + i, size - i, value);
+}
+
+TARGET("sse2") static size_t sse2_find(const int *data, size_t size, int value)
+{
+    __m128i needle = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (data + i)), needle);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    size_t pos = scalar_find(data + i, size - i, value);
+    return pos == (size_t) -1 ? pos : i + pos;
+}
+
+// Since data is sorted, the lanes lower than value are always the first ones of a register.
+TARGET("sse2") static size_t sse2_skip_less(const int *data, size_t size, int value)
+{
+    __m128i needle = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i less = _mm_cmpgt_epi32(needle, _mm_loadu_si128((const __m128i *) (data + i)));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(less));
+        if (mask != 0xF)
+            return i + __builtin_popcount(mask);
+    }
+    return i + scalar_skip_less(data + i, size - i, value);
+}
+
+/* SSE2 can't move lanes around by a mask, so registers without the value are stored as they are and the rest
+ * fall back to scalar code. Writes never get ahead of reads, so compacting in place is safe. */
+TARGET("sse2") static size_t sse2_remove(int *data, size_t size, int value)
+{
+    __m128i needle = _mm_set1_epi32(value);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (data + i));
+        if (!_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle)))) {
+            _mm_storeu_si128((__m128i *) (data + kept), v);
+            kept += 4;
+        } else {
+            kept += scalar_compact(data + kept, data + i, 4, value);
+        }
+    }
+    return kept + scalar_compact(data + kept, data + i, size - i, value);
+}
+
+// Same layout as scalar_unpack(), every lane is shifted by the same amount so all 4 of them unpack at once.
+TARGET("sse2") static void sse2_unpack(const uint32_t *words, unsigned bits, uint32_t reference, uint32_t *out)
+{
+    __m128i base = _mm_set1_epi32((int) reference);
+    if (bits == 0) {
+        for (size_t k = 0; k < 32; ++k)
+            _mm_storeu_si128((__m128i *) (out + k * 4), base);
+        return;
+    }
+
+    __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : (int) (((uint32_t) 1 << bits) - 1));
+    const __m128i *in = (const __m128i *) words;
+    __m128i current = _mm_loadu_si128(in++);
+    unsigned shift = 0;
+    for (size_t k = 0; k < 32; ++k) {
+        __m128i value = _mm_srl_epi32(current, _mm_cvtsi32_si128((int) shift));
+        shift += bits;
+        // The last number ends exactly at the end of the last word, so nothing past it is loaded.
+        if (shift >= 32 && k < 31) {
+            shift -= 32;
+            current = _mm_loadu_si128(in++);
+            if (shift > 0)
+                value = _mm_or_si128(value, _mm_sll_epi32(current, _mm_cvtsi32_si128((int) (bits - shift))));
+        }
+        value = _mm_add_epi32(_mm_and_si128(value, mask), base);
+        _mm_storeu_si128((__m128i *) (out + k * 4), value);
+    }
+}
+
+// Adds up 4 numbers at a time with two shifted adds, then carries the last sum over to the next 4.
+TARGET("sse2") static void sse2_prefix_sum(uint32_t *data, size_t size)
+{
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i sums = _mm_loadu_si128((const __m128i *) (data + i));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 4));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 8));
+        sums = _mm_add_epi32(sums, carry);
+        _mm_storeu_si128((__m128i *) (data + i), sums);
+        carry = _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    for (; i < size; ++i)
+        data[i] += i ? data[i - 1] : 0;
+}
+
+/* Loads are aligned so they never cross into the next page, the bytes before value in the first one are ignored.
+ * They may still read past the end of the string, which AddressSanitizer would report. */
+TARGET("sse2") NO_SANITIZE_ADDRESS static size_t sse2_strlen(const char *value)
+{
+    uintptr_t misalignment = (uintptr_t) value % 16;
+    const char *block = value - misalignment;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_load_si128((const __m128i *) block);
+    unsigned mask = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)) >> misalignment;
+    if (mask)
+        return __builtin_ctz(mask);
+
+    for (;;) {
+        block += 16;
+        mask = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) block), zero));
+        if (mask)
+            return block - value + __builtin_ctz(mask);
+    }
+}
+
+/* Candidates are the positions where both the first and the last byte of needle match, checked 16 at a time,
+ * and only those are compared in full. */
+TARGET("sse2") static size_t sse2_search(const char *data, size_t size, const char *needle, size_t needle_size)
+{
+    if (needle_size == 0)
+        return 0;
+
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_size - 1]);
+    size_t i = 0;
+    for (; i + needle_size - 1 + 16 <= size; i += 16) {
+        __m128i starts = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *) (data + i)));
+        __m128i ends = _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *) (data + i + needle_size - 1)));
+        unsigned candidates = (unsigned) _mm_movemask_epi8(_mm_and_si128(starts, ends));
+        for (; candidates; candidates &= candidates - 1) {
+            size_t position = i + __builtin_ctz(candidates);
+            if (memcmp(data + position, needle, needle_size) == 0)
+                return position;
+        }
+    }
+
+    size_t found = scalar_search(data + i, size - i, needle, needle_size);
+    return found == (size_t) -1 ? found : i + found;
+}
+
+static const SimdKernels sse2_kernels = {
+    sse2_sum, sse2_min, sse2_max, sse2_count, sse2_find, sse2_skip_less, sse2_remove,
+    sse2_unpack, sse2_prefix_sum, sse2_strlen, sse2_search
+};
+
+TARGET("avx2") static long long avx2_sum(const int *data, size_t size)
+{
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (data + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_sum(data + i, size - i);
+}
+
+TARGET("avx2") static int avx2_min(const int *data, size_t size)
+{
+    __m256i acc = _mm256_set1_epi32(INT_MAX);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i *) (data + i)));
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    int min = scalar_min(lanes, 8);
+    int tail = scalar_min(data + i, size - i);
+    return tail < min ? tail : min;
+}
+
+TARGET("avx2") static int avx2_max(const int *data, size_t size)
+{
+    __m256i acc = _mm256_set1_epi32(INT_MIN);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        acc = _mm256_max_epi32(acc, _mm256_loadu_si256((const __m256i *) (data + i)));
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    int max = scalar_max(lanes, 8);
+    int tail = scalar_max(data + i, size - i);
+    return tail > max ? tail : max;
+}
+
+TARGET("avx2") static size_t avx2_count(const int *data, size_t size, int value)
+{
+    __m256i needle = _mm256_set1_epi32(value);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (data + i)), needle);
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+    }
+    return count + scalar_count(data + i, size - i, value);
+}
+
+TARGET("avx2") static size_t avx2_find(const int *data, size_t size, int value)
+{
+    __m256i needle = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (data + i)), needle);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    size_t pos = scalar_find(data + i, size - i, value);
+    return pos == (size_t) -1 ? pos : i + pos;
+}
+
+TARGET("avx2") static size_t avx2_skip_less(const int *data, size_t size, int value)
+{
+    __m256i needle = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i less = _mm256_cmpgt_epi32(needle, _mm256_loadu_si256((const __m256i *) (data + i)));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(less));
+        if (mask != 0xFF)
+            return i + __builtin_popcount(mask);
+    }
+    return i + scalar_skip_less(data + i, size - i, value);
+}
+
+/* For every 8-bit mask of lanes to keep, the indices of those lanes packed at the start, one per byte.
+ * Generated, entry m lists the set bits of m from the lowest one. */
+static const unsigned long long avx2_compress_table[256] = {
+    0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000001ull, 0x0000000000000100ull,
+    0x0000000000000002ull, 0x0000000000000200ull, 0x0000000000000201ull, 0x0000000000020100ull,
+    0x0000000000000003ull, 0x0000000000000300ull, 0x0000000000000301ull, 0x0000000000030100ull,
+    0x0000000000000302ull, 0x0000000000030200ull, 0x0000000000030201ull, 0x0000000003020100ull,
+    0x0000000000000004ull, 0x0000000000000400ull, 0x0000000000000401ull, 0x0000000000040100ull,
+    0x0000000000000402ull, 0x0000000000040200ull, 0x0000000000040201ull, 0x0000000004020100ull,
+    0x0000000000000403ull, 0x0000000000040300ull, 0x0000000000040301ull, 0x0000000004030100ull,
+    0x0000000000040302ull, 0x0000000004030200ull, 0x0000000004030201ull, 0x0000000403020100ull,
+    0x0000000000000005ull, 0x0000000000000500ull, 0x0000000000000501ull, 0x0000000000050100ull,
+    0x0000000000000502ull, 0x0000000000050200ull, 0x0000000000050201ull, 0x0000000005020100ull,
+    0x0000000000000503ull, 0x0000000000050300ull, 0x0000000000050301ull, 0x0000000005030100ull,
+    0x0000000000050302ull, 0x0000000005030200ull, 0x0000000005030201ull, 0x0000000503020100ull,
+    0x0000000000000504ull, 0x0000000000050400ull, 0x0000000000050401ull, 0x0000000005040100ull,
+    0x0000000000050402ull, 0x0000000005040200ull, 0x0000000005040201ull, 0x0000000504020100ull,
+    0x0000000000050403ull, 0x0000000005040300ull, 0x0000000005040301ull, 0x0000000504030100ull,
+    0x0000000005040302ull, 0x0000000504030200ull, 0x0000000504030201ull, 0x0000050403020100ull,
+    0x0000000000000006ull, 0x0000000000000600ull, 0x0000000000000601ull, 0x0000000000060100ull,
+    0x0000000000000602ull, 0x0000000000060200ull, 0x0000000000060201ull, 0x0000000006020100ull,
+    0x0000000000000603ull, 0x0000000000060300ull, 0x0000000000060301ull, 0x0000000006030100ull,
+    0x0000000000060302ull, 0x0000000006030200ull, 0x0000000006030201ull, 0x0000000603020100ull,
+    0x0000000000000604ull, 0x0000000000060400ull, 0x0000000000060401ull, 0x0000000006040100ull,
+    0x0000000000060402ull, 0x0000000006040200ull, 0x0000000006040201ull, 0x0000000604020100ull,
+    0x0000000000060403ull, 0x0000000006040300ull, 0x0000000006040301ull, 0x0000000604030100ull,
+    0x0000000006040302ull, 0x0000000604030200ull, 0x0000000604030201ull, 0x0000060403020100ull,
+    0x0000000000000605ull, 0x0000000000060500ull, 0x0000000000060501ull, 0x0000000006050100ull,
+    0x0000000000060502ull, 0x0000000006050200ull, 0x0000000006050201ull, 0x0000000605020100ull,
+    0x0000000000060503ull, 0x0000000006050300ull, 0x0000000006050301ull, 0x0000000605030100ull,
+    0x0000000006050302ull, 0x0000000605030200ull, 0x0000000605030201ull, 0x0000060503020100ull,
+    0x0000000000060504ull, 0x0000000006050400ull, 0x0000000006050401ull, 0x0000000605040100ull,
+    0x0000000006050402ull, 0x0000000605040200ull, 0x0000000605040201ull, 0x0000060504020100ull,
+    0x0000000006050403ull, 0x0000000605040300ull, 0x0000000605040301ull, 0x0000060504030100ull,
+    0x0000000605040302ull, 0x0000060504030200ull, 0x0000060504030201ull, 0x0006050403020100ull,
+    0x0000000000000007ull, 0x0000000000000700ull, 0x0000000000000701ull, 0x0000000000070100ull,
+    0x0000000000000702ull, 0x0000000000070200ull, 0x0000000000070201ull, 0x0000000007020100ull,
+    0x0000000000000703ull, 0x0000000000070300ull, 0x0000000000070301ull, 0x0000000007030100ull,
+    0x0000000000070302ull, 0x0000000007030200ull, 0x0000000007030201ull, 0x0000000703020100ull,
+    0x0000000000000704ull, 0x0000000000070400ull, 0x0000000000070401ull, 0x0000000007040100ull,
+    0x0000000000070402ull, 0x0000000007040200ull, 0x0000000007040201ull, 0x0000000704020100ull,
+    0x0000000000070403ull, 0x0000000007040300ull, 0x0000000007040301ull, 0x0000000704030100ull,
+    0x0000000007040302ull, 0x0000000704030200ull, 0x0000000704030201ull, 0x0000070403020100ull,
+    0x0000000000000705ull, 0x0000000000070500ull, 0x0000000000070501ull, 0x0000000007050100ull,
+    0x0000000000070502ull, 0x0000000007050200ull, 0x0000000007050201ull, 0x0000000705020100ull,
+    0x0000000000070503ull, 0x0000000007050300ull, 0x0000000007050301ull, 0x0000000705030100ull,
+    0x0000000007050302ull, 0x0000000705030200ull, 0x0000000705030201ull, 0x0000070503020100ull,
+    0x0000000000070504ull, 0x0000000007050400ull, 0x0000000007050401ull, 0x0000000705040100ull,
+    0x0000000007050402ull, 0x0000000705040200ull, 0x0000000705040201ull, 0x0000070504020100ull,
+    0x0000000007050403ull, 0x0000000705040300ull, 0x0000000705040301ull, 0x0000070504030100ull,
+    0x0000000705040302ull, 0x0000070504030200ull, 0x0000070504030201ull, 0x0007050403020100ull,
+    0x0000000000000706ull, 0x0000000000070600ull, 0x0000000000070601ull, 0x0000000007060100ull,
+    0x0000000000070602ull, 0x0000000007060200ull, 0x0000000007060201ull, 0x0000000706020100ull,
+    0x0000000000070603ull, 0x0000000007060300ull, 0x0000000007060301ull, 0x0000000706030100ull,
+    0x0000000007060302ull, 0x0000000706030200ull, 0x0000000706030201ull, 0x0000070603020100ull,
+    0x0000000000070604ull, 0x0000000007060400ull, 0x0000000007060401ull, 0x0000000706040100ull,
+    0x0000000007060402ull, 0x0000000706040200ull, 0x0000000706040201ull, 0x0000070604020100ull,
+    0x0000000007060403ull, 0x0000000706040300ull, 0x0000000706040301ull, 0x0000070604030100ull,
+    0x0000000706040302ull, 0x0000070604030200ull, 0x0000070604030201ull, 0x0007060403020100ull,
+    0x0000000000070605ull, 0x0000000007060500ull, 0x0000000007060501ull, 0x0000000706050100ull,
+    0x0000000007060502ull, 0x0000000706050200ull, 0x0000000706050201ull, 0x0000070605020100ull,
+    0x0000000007060503ull, 0x0000000706050300ull, 0x0000000706050301ull, 0x0000070605030100ull,
+    0x0000000706050302ull, 0x0000070605030200ull, 0x0000070605030201ull, 0x0007060503020100ull,
+    0x0000000007060504ull, 0x0000000706050400ull, 0x0000000706050401ull, 0x0000070605040100ull,
+    0x0000000706050402ull, 0x0000070605040200ull, 0x0000070605040201ull, 0x0007060504020100ull,
+    0x0000000706050403ull, 0x0000070605040300ull, 0x0000070605040301ull, 0x0007060504030100ull,
+    0x0000070605040302ull, 0x0007060504030200ull, 0x0007060504030201ull, 0x0706050403020100ull
+};
+
+// Kept lanes are packed at the start of the register with a permutation looked up by mask, then stored whole.
+TARGET("avx2") static size_t avx2_remove(int *data, size_t size, int value)
+{
+    __m256i needle = _mm256_set1_epi32(value);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (data + i));
+        int equal = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle)));
+        int keep = ~equal & 0xFF;
+        __m256i permutation = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long) avx2_compress_table[keep]));
+        _mm256_storeu_si256((__m256i *) (data + kept), _mm256_permutevar8x32_epi32(v, permutation));
+        kept += __builtin_popcount(keep);
+    }
+    return kept + scalar_compact(data + kept, data + i, size - i, value);
+}
+
+TARGET("avx2") NO_SANITIZE_ADDRESS static size_t avx2_strlen(const char *value)
+{
+    uintptr_t misalignment = (uintptr_t) value % 32;
+    const char *block = value - misalignment;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i bytes = _mm256_load_si256((const __m256i *) block);
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zero)) >> misalignment;
+    if (mask)
+        return __builtin_ctz(mask);
+
+    for (;;) {
+        block += 32;
+        mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *) block), zero));
+        if (mask)
+            return block - value + __builtin_ctz(mask);
+    }
+}
+
+TARGET("avx2") static size_t avx2_search(const char *data, size_t size, const char *needle, size_t needle_size)
+{
+    if (needle_size == 0)
+        return 0;
+
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_size - 1]);
+    size_t i = 0;
+    for (; i + needle_size - 1 + 32 <= size; i += 32) {
+        __m256i starts = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *) (data + i)));
+        __m256i ends = _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *) (data + i + needle_size - 1)));
+        uint32_t candidates = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(starts, ends));
+        for (; candidates; candidates &= candidates - 1) {
+            size_t position = i + __builtin_ctz(candidates);
+            if (memcmp(data + position, needle, needle_size) == 0)
+                return position;
+        }
+    }
+
+    size_t found = sse2_search(data + i, size - i, needle, needle_size);
+    return found == (size_t) -1 ? found : i + found;
+}
+
+static const SimdKernels avx2_kernels = {
+    avx2_sum, avx2_min, avx2_max, avx2_count, avx2_find, avx2_skip_less, avx2_remove,
+    sse2_unpack, sse2_prefix_sum, avx2_strlen, avx2_search
+};
+
+TARGET("avx512f") static long long avx512_sum(const int *data, size_t size)
+{
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void *) (data + i));
+        acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    return _mm512_reduce_add_epi64(acc) + scalar_sum(data + i, size - i);
+}
+
+TARGET("avx512f") static int avx512_min(const int *data, size_t size)
+{
+    __m512i acc = _mm512_set1_epi32(INT_MAX);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+        acc = _mm512_min_epi32(acc, _mm512_loadu_si512((const void *) (data + i)));
+
+    int min = _mm512_reduce_min_epi32(acc);
+    int tail = scalar_min(data + i, size - i);
+    return tail < min ? tail : min;
+}
+
+TARGET("avx512f") static int avx512_max(const int *data, size_t size)
+{
+    __m512i acc = _mm512_set1_epi32(INT_MIN);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+        acc = _mm512_max_epi32(acc, _mm512_loadu_si512((const void *) (data + i)));
+
+    int max = _mm512_reduce_max_epi32(acc);
+    int tail = scalar_max(data + i, size - i);
+    return tail > max ? tail : max;
+}
+
+TARGET("avx512f") static size_t avx512_count(const int *data, size_t size, int value)
+{
+    __m512i needle = _mm512_set1_epi32(value);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __mmask16 equal = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void *) (data + i)), needle);
+        count += __builtin_popcount(equal);
+    }
+    return count + scalar_count(data + i, size - i, value);
+}
+
+TARGET("avx512f") static size_t avx512_find(const int *data, size_t size, int value)
+{
+    __m512i needle = _mm512_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __mmask16 equal = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void *) (data + i)), needle);
+        if (equal)
+            return i + __builtin_ctz(equal);
+    }
+
+    size_t pos = scalar_find(data + i, size - i, value);
+    return pos == (size_t) -1 ? pos : i + pos;
+}
+
+TARGET("avx512f") static size_t avx512_skip_less(const int *data, size_t size, int value)
+{
+    __m512i needle = _mm512_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __mmask16 less = _mm512_cmplt_epi32_mask(_mm512_loadu_si512((const void *) (data + i)), needle);
+        if (less != 0xFFFF)
+            return i + __builtin_popcount(less);
+    }
+    return i + scalar_skip_less(data + i, size - i, value);
+}
+
+TARGET("avx512f") static size_t avx512_remove(int *data, size_t size, int value)
+{
+    __m512i needle = _mm512_set1_epi32(value);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void *) (data + i));
+        __mmask16 keep = _mm512_cmpneq_epi32_mask(v, needle);
+        _mm512_mask_compressstoreu_epi32(data + kept, keep, v);
+        kept += __builtin_popcount(keep);
+    }
+    return kept + scalar_compact(data + kept, data + i, size - i, value);
+}
+
+static const SimdKernels avx512_kernels = {
+    avx512_sum, avx512_min, avx512_max, avx512_count, avx512_find, avx512_skip_less, avx512_remove,
+    sse2_unpack, sse2_prefix_sum, avx2_strlen, avx2_search
+};
+
+static enum SIMD_LEVEL detect_level(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+    return SIMD_SCALAR;
+}
+
+static const SimdKernels *const all_kernels[] = {
+    &scalar_kernels, &sse2_kernels, &avx2_kernels, &avx512_kernels
+};
+
+#else
+
+static enum SIMD_LEVEL detect_level(void)
+{
+    return SIMD_SCALAR;
+}
+
+static const SimdKernels *const all_kernels[] = { &scalar_kernels };
+
+#endif // SIMD_X86
+
+// -1 until the first kernel call detects what the CPU supports.
+static atomic_int supported_level = -1;
+static atomic_int current_level = -1;
+
+enum SIMD_LEVEL simd_get_level(void)
+{
+    int level = atomic_load_explicit(&current_level, memory_order_relaxed);
+    if (level < 0) {
+        level = detect_level();
+        atomic_store_explicit(&supported_level, level, memory_order_relaxed);
+        atomic_store_explicit(&current_level, level, memory_order_relaxed);
+    }
+    return level;
+}
+
+void simd_set_level(enum SIMD_LEVEL level)
+{
+    simd_get_level();
+    int supported = atomic_load_explicit(&supported_level, memory_order_relaxed);
+    atomic_store_explicit(&current_level, (int) level < supported ? (int) level : supported, memory_order_relaxed);
+}
+
+const char *simd_level_name(enum SIMD_LEVEL level)
+{
+    switch (level) {
+    case SIMD_SCALAR:
+        return "scalar";
+    case SIMD_SSE2:
+        return "sse2";
+    case SIMD_AVX2:
+        return "avx2";
+    case SIMD_AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+static const SimdKernels *kernels(void)
+{
+    return all_kernels[simd_get_level()];
+}
+
+long long simd_sum(const int *data, size_t size)
+{
+    return kernels()->sum(data, size);
+}
+
+int simd_min(const int *data, size_t size)
+{
+    return kernels()->min(data, size);
+}
+
+int simd_max(const int *data, size_t size)
+{
+    return kernels()->max(data, size);
+}
+
+size_t simd_count(const int *data, size_t size, int value)
+{
+    return kernels()->count(data, size, value);
+}
+
+size_t simd_find(const int *data, size_t size, int value)
+{
+    return kernels()->find(data, size, value);
+}
+
+size_t simd_skip_less(const int *data, size_t size, int value)
+{
+    return kernels()->skip_less(data, size, value);
+}
+
+size_t simd_remove(int *data, size_t size, int value)
+{
+    // Nothing moves before the first match, so compacting only starts there.
+    const SimdKernels *selected = kernels();
+    size_t first = selected->find(data, size, value);
+    if (first == (size_t) -1)
+        return size;
+    return first + selected->remove(data + first, size - first, value);
+}
+
+void simd_unpack(const uint32_t *words, unsigned bits, uint32_t reference, uint32_t out[128])
+{
+    kernels()->unpack(words, bits, reference, out);
+}
+
+void simd_prefix_sum(uint32_t *data, size_t size)
+{
+    kernels()->prefix_sum(data, size);
+}
+
+size_t simd_strlen(const char *value)
+{
+    return kernels()->strlen(value);
+}
+
+size_t simd_search(const char *data, size_t size, const char *needle, size_t needle_size)
+{
+    return kernels()->search(data, size, needle, needle_size);
+}
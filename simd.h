@@ -0,0 +1,43 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Kernels working on plain arrays of ints and on strings. Each of them has a scalar version plus SSE2, AVX2 and
+ * AVX-512 versions on x86, the best one the CPU supports is picked the first time any kernel is called.
+ * Every version gives exactly the same results. */
+enum SIMD_LEVEL {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+enum SIMD_LEVEL simd_get_level(void);
+// Forces a lower level, e.g. to compare against the scalar kernels. Levels the CPU doesn't support are ignored.
+void simd_set_level(enum SIMD_LEVEL level);
+const char *simd_level_name(enum SIMD_LEVEL level);
+
+long long simd_sum(const int *data, size_t size);
+int simd_min(const int *data, size_t size);
+int simd_max(const int *data, size_t size);
+size_t simd_count(const int *data, size_t size, int value);
+// Returns the index of the first item equal to value, or -1 if there is none.
+size_t simd_find(const int *data, size_t size, int value);
+/* data must be sorted in ascending order. Returns how many items at the start of data are lower than value,
+ * scanning a whole register at a time. Sorted set operations use it to skip runs of items. */
+size_t simd_skip_less(const int *data, size_t size, int value);
+// Removes every item equal to value from data, keeping the order of the rest. Returns how many items are left.
+size_t simd_remove(int *data, size_t size, int value);
+/* Unpacks a block of 128 numbers of bits bits each, see packed.h for the layout, adding reference to all of them.
+ * Wider registers don't help with a block this small, so every level above SSE2 uses the SSE2 kernel. */
+void simd_unpack(const uint32_t *words, unsigned bits, uint32_t reference, uint32_t out[128]);
+// Replaces every number of data with the sum of the numbers up to it, wrapping around on overflow.
+void simd_prefix_sum(uint32_t *data, size_t size);
+/* String kernels. AVX-512 uses the AVX2 ones. simd_search() returns where needle first appears in data[0, size),
+ * or -1 if it doesn't, candidates are filtered on the first and last byte of needle a whole register at a time. */
+size_t simd_strlen(const char *value);
+size_t simd_search(const char *data, size_t size, const char *needle, size_t needle_size);
+
+#endif // SIMD_H
@@ -0,0 +1,249 @@
+#include "vector.h"
+#include "logger.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* LSD radix sort, one byte per pass. Flipping the sign bit makes signed ints sort as unsigned keys,
+ * passes where every key has the same byte are skipped. */
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (32 / RADIX_BITS)
+
+static inline unsigned radix_digit(int value, unsigned pass)
+{
+    return (((uint32_t) value ^ 0x80000000u) >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+static void insertion_sort(int *data, size_t size)
+{
+    for (size_t i = 1; i < size; ++i) {
+        int value = data[i];
+        size_t j = i;
+        for (; j > 0 && data[j - 1] > value; --j)
+            data[j] = data[j - 1];
+        data[j] = value;
+    }
+}
+
+/* Uses the spare capacity of vector as scratch memory when it's big enough, otherwise allocates it.
+ * Returns NULL if there is no memory for it. */
+static int *sort_scratch(IntVector *vector, bool *allocated)
+{
+    *allocated = vector->size - vector->offset < vector->offset;
+    if (!*allocated)
+        return vector->data + vector->offset;
+
+    int *scratch = (int *) malloc(vector->offset * sizeof(int));
+    if (!scratch) {
+        LOG_ERROR("There was an error while allocating scratch memory to sort vector: %p.", (void *) vector);
+    }
+    return scratch;
+}
+
+static void radix_sort(int *data, int *scratch, size_t size)
+{
+    size_t counts[RADIX_PASSES][RADIX_BUCKETS] = { { 0 } };
+    for (size_t i = 0; i < size; ++i) {
+        for (unsigned pass = 0; pass < RADIX_PASSES; ++pass)
+            ++counts[pass][radix_digit(data[i], pass)];
+    }
+
+    int *src = data;
+    int *dst = scratch;
+    for (unsigned pass = 0; pass < RADIX_PASSES; ++pass) {
+        size_t *count = counts[pass];
+        if (count[radix_digit(src[0], pass)] == size)
+            continue;
+
+        size_t offsets[RADIX_BUCKETS];
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+            offsets[bucket] = offset;
+            offset += count[bucket];
+        }
+
+        for (size_t i = 0; i < size; ++i)
+            dst[offsets[radix_digit(src[i], pass)]++] = src[i];
+
+        int *temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    if (src != data)
+        memcpy(data, src, size * sizeof(int));
+}
+
+void int_vector_sort(IntVector *vector)
+{
+    size_t size = vector->offset;
+    LOG_INFO("Sorting %li numbers in vector: %p...", size, (void *) vector);
+
+    if (size <= SORT_INSERTION_THRESHOLD) {
+        insertion_sort(vector->data, size);
+        return;
+    }
+
+    bool allocated;
+    int *scratch = sort_scratch(vector, &allocated);
+    if (!scratch)
+        return;
+
+    radix_sort(vector->data, scratch, size);
+
+    if (allocated)
+        free(scratch);
+    LOG_INFO("Vector: %p sorted.", (void *) vector);
+}
+
+typedef struct {
+    size_t threads;
+    size_t size;
+    int *data;
+    int *scratch;
+    // One histogram per thread, for the pass being done.
+    size_t (*counts)[RADIX_BUCKETS];
+    pthread_barrier_t barrier;
+    // Workers wait here until the amount of threads that could actually be started is known.
+    pthread_mutex_t gate;
+    pthread_cond_t started;
+    bool ready;
+} ParallelSort;
+
+typedef struct {
+    ParallelSort *sort;
+    size_t id;
+} ParallelSortWorker;
+
+/* Every pass is done in three steps by all threads: a histogram of their own chunk, the prefix sum
+ * over every thread's histogram to know where their keys go, and the scatter of their chunk. */
+static void *parallel_sort_worker(void *arg)
+{
+    ParallelSortWorker *worker = (ParallelSortWorker *) arg;
+    ParallelSort *sort = worker->sort;
+    size_t id = worker->id;
+
+    pthread_mutex_lock(&sort->gate);
+    while (!sort->ready)
+        pthread_cond_wait(&sort->started, &sort->gate);
+    pthread_mutex_unlock(&sort->gate);
+
+    size_t chunk = (sort->size + sort->threads - 1) / sort->threads;
+    size_t start = id * chunk < sort->size ? id * chunk : sort->size;
+    size_t end = start + chunk < sort->size ? start + chunk : sort->size;
+
+    int *src = sort->data;
+    int *dst = sort->scratch;
+
+    for (unsigned pass = 0; pass < RADIX_PASSES; ++pass) {
+        size_t *count = sort->counts[id];
+        memset(count, 0, RADIX_BUCKETS * sizeof(size_t));
+        for (size_t i = start; i < end; ++i)
+            ++count[radix_digit(src[i], pass)];
+
+        pthread_barrier_wait(&sort->barrier);
+
+        // Every thread sees the same histograms, so they all agree on skipping a pass.
+        size_t offsets[RADIX_BUCKETS];
+        size_t offset = 0;
+        bool skip = false;
+        for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+            size_t total = 0;
+            for (size_t thread = 0; thread < sort->threads; ++thread) {
+                if (thread == id)
+                    offsets[bucket] = offset + total;
+                total += sort->counts[thread][bucket];
+            }
+            if (total == sort->size)
+                skip = true;
+            offset += total;
+        }
+
+        if (!skip) {
+            for (size_t i = start; i < end; ++i)
+                dst[offsets[radix_digit(src[i], pass)]++] = src[i];
+
+            int *temp = src;
+            src = dst;
+            dst = temp;
+        }
+
+        pthread_barrier_wait(&sort->barrier);
+    }
+
+    if (src != sort->data)
+        memcpy(sort->data + start, src + start, (end - start) * sizeof(int));
+
+    return NULL;
+}
+
+void int_vector_parallel_sort(IntVector *vector, size_t threads)
+{
+    size_t size = vector->offset;
+    if (threads <= 1 || size < SORT_PARALLEL_THRESHOLD) {
+        int_vector_sort(vector);
+        return;
+    }
+
+    LOG_INFO("Sorting %li numbers in vector: %p with %li threads...", size, (void *) vector, threads);
+
+    bool allocated;
+    int *scratch = sort_scratch(vector, &allocated);
+    if (!scratch)
+        return;
+
+    ParallelSort sort = { .threads = threads, .size = size, .data = vector->data, .scratch = scratch };
+    ParallelSortWorker *workers = (ParallelSortWorker *) malloc(threads * sizeof(ParallelSortWorker));
+    pthread_t *ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+    sort.counts = malloc(threads * sizeof(*sort.counts));
+
+    if (!workers || !ids || !sort.counts) {
+        LOG_ERROR("There was an error while allocating memory to sort vector: %p.", (void *) vector);
+        free(workers);
+        free(ids);
+        free(sort.counts);
+        if (allocated)
+            free(scratch);
+        return;
+    }
+
+    pthread_mutex_init(&sort.gate, NULL);
+    pthread_cond_init(&sort.started, NULL);
+    for (size_t i = 0; i < threads; ++i) {
+        workers[i].sort = &sort;
+        workers[i].id = i;
+    }
+
+    // The calling thread is worker 0.
+    pthread_mutex_lock(&sort.gate);
+    size_t started = 1;
+    while (started < threads && pthread_create(&ids[started], NULL, parallel_sort_worker, &workers[started]) == 0)
+        ++started;
+
+    if (started < threads)
+        LOG_WARN("Could only start %li threads to sort vector: %p.", started, (void *) vector);
+
+    sort.threads = started;
+    pthread_barrier_init(&sort.barrier, NULL, started);
+    sort.ready = true;
+    pthread_cond_broadcast(&sort.started);
+    pthread_mutex_unlock(&sort.gate);
+
+    parallel_sort_worker(&workers[0]);
+    for (size_t i = 1; i < started; ++i)
+        pthread_join(ids[i], NULL);
+
+    pthread_barrier_destroy(&sort.barrier);
+    pthread_cond_destroy(&sort.started);
+    pthread_mutex_destroy(&sort.gate);
+    free(workers);
+    free(ids);
+    free(sort.counts);
+    if (allocated)
+        free(scratch);
+
+    LOG_INFO("Vector: %p sorted.", (void *) vector);
+}
@@ -0,0 +1,232 @@
+#include "vector.h"
+#include "logger.h"
+#include "simd.h"
+
+#include <string.h>
+
+/* Branchless binary search: the range is halved every step with a conditional move instead of a jump,
+ * so there is nothing for the CPU to mispredict, and both possible next probes are prefetched. */
+static size_t lower_bound(const int *data, size_t size, int value)
+{
+    if (size == 0)
+        return 0;
+
+    const int *base = data;
+    while (size > 1) {
+        size_t half = size / 2;
+        __builtin_prefetch(base + half / 2);
+        __builtin_prefetch(base + half + half / 2);
+        base = base[half] < value ? base + half : base;
+        size -= half;
+    }
+    return (base - data) + (*base < value);
+}
+
+static size_t upper_bound(const int *data, size_t size, int value)
+{
+    if (size == 0)
+        return 0;
+
+    const int *base = data;
+    while (size > 1) {
+        size_t half = size / 2;
+        __builtin_prefetch(base + half / 2);
+        __builtin_prefetch(base + half + half / 2);
+        base = base[half] <= value ? base + half : base;
+        size -= half;
+    }
+    return (base - data) + (*base <= value);
+}
+
+size_t int_vector_lower_bound(const IntVector *vector, int value)
+{
+    return lower_bound(vector->data, vector->offset, value);
+}
+
+size_t int_vector_upper_bound(const IntVector *vector, int value)
+{
+    return upper_bound(vector->data, vector->offset, value);
+}
+
+bool int_vector_contains(const IntVector *vector, int value)
+{
+    size_t pos = lower_bound(vector->data, vector->offset, value);
+    return pos < vector->offset && vector->data[pos] == value;
+}
+
+// Plain binary searches for strided views, whose numbers can't be prefetched a cache line at a time.
+static size_t strided_lower_bound(const int *data, size_t size, size_t stride, int value)
+{
+    size_t low = 0;
+    while (size > 0) {
+        size_t half = size / 2;
+        if (data[(low + half) * stride] < value) {
+            low += half + 1;
+            size -= half + 1;
+        } else {
+            size = half;
+        }
+    }
+    return low;
+}
+
+static size_t strided_upper_bound(const int *data, size_t size, size_t stride, int value)
+{
+    size_t low = 0;
+    while (size > 0) {
+        size_t half = size / 2;
+        if (data[(low + half) * stride] <= value) {
+            low += half + 1;
+            size -= half + 1;
+        } else {
+            size = half;
+        }
+    }
+    return low;
+}
+
+size_t int_vector_view_lower_bound(IntVectorView view, int value)
+{
+    if (view.stride == 1)
+        return lower_bound(view.data, view.size, value);
+    return strided_lower_bound(view.data, view.size, view.stride, value);
+}
+
+size_t int_vector_view_upper_bound(IntVectorView view, int value)
+{
+    if (view.stride == 1)
+        return upper_bound(view.data, view.size, value);
+    return strided_upper_bound(view.data, view.size, view.stride, value);
+}
+
+bool int_vector_view_contains(IntVectorView view, int value)
+{
+    size_t pos = int_vector_view_lower_bound(view, value);
+    return pos < view.size && view.data[pos * view.stride] == value;
+}
+
+// Empties dest and makes room for size numbers in it. Returns false if dest can't be used as destination.
+static bool set_destination(const IntVector *a, const IntVector *b, IntVector *dest, size_t size)
+{
+    if (dest == a || dest == b) {
+        LOG_ERROR("Destination vector: %p must not be one of the source vectors.", (void *) dest);
+        return false;
+    }
+
+    if (!dest->data) {
+        LOG_ERROR(
+            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
+            (void *) dest
+        );
+        return false;
+    }
+
+    dest->offset = 0;
+    int_vector_reserve(dest, size);
+    return dest->size >= size;
+}
+
+static void append_run(IntVector *dest, const int *run, size_t size)
+{
+    memcpy(dest->data + dest->offset, run, size * sizeof(int));
+    dest->offset += size;
+}
+
+/* Set operations follow the same rules as the C++ std::set_* algorithms, duplicates included.
+ * Runs of items lower than the other vector's current item are skipped a whole register at a time. */
+void int_vector_intersect(const IntVector *a, const IntVector *b, IntVector *dest)
+{
+    size_t a_size = a->offset;
+    size_t b_size = b->offset;
+    if (!set_destination(a, b, dest, a_size < b_size ? a_size : b_size))
+        return;
+
+    LOG_INFO("Intersecting vector: %p and vector: %p into vector: %p...", (void *) a, (void *) b, (void *) dest);
+
+    // When one list is much shorter, looking its items up in the longer one beats merging them.
+    if (a_size * 32 < b_size || b_size * 32 < a_size) {
+        const IntVector *small = a_size < b_size ? a : b;
+        const IntVector *large = a_size < b_size ? b : a;
+        size_t j = 0;
+        for (size_t i = 0; i < small->offset && j < large->offset; ++i) {
+            j += lower_bound(large->data + j, large->offset - j, small->data[i]);
+            if (j < large->offset && large->data[j] == small->data[i]) {
+                dest->data[dest->offset++] = small->data[i];
+                ++j;
+            }
+        }
+        return;
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_size && j < b_size) {
+        if (a->data[i] < b->data[j]) {
+            i += simd_skip_less(a->data + i, a_size - i, b->data[j]);
+        } else if (b->data[j] < a->data[i]) {
+            j += simd_skip_less(b->data + j, b_size - j, a->data[i]);
+        } else {
+            dest->data[dest->offset++] = a->data[i];
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void int_vector_union(const IntVector *a, const IntVector *b, IntVector *dest)
+{
+    size_t a_size = a->offset;
+    size_t b_size = b->offset;
+    if (!set_destination(a, b, dest, a_size + b_size))
+        return;
+
+    LOG_INFO("Merging vector: %p and vector: %p into vector: %p...", (void *) a, (void *) b, (void *) dest);
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_size && j < b_size) {
+        if (a->data[i] < b->data[j]) {
+            size_t run = simd_skip_less(a->data + i, a_size - i, b->data[j]);
+            append_run(dest, a->data + i, run);
+            i += run;
+        } else if (b->data[j] < a->data[i]) {
+            size_t run = simd_skip_less(b->data + j, b_size - j, a->data[i]);
+            append_run(dest, b->data + j, run);
+            j += run;
+        } else {
+            dest->data[dest->offset++] = a->data[i];
+            ++i;
+            ++j;
+        }
+    }
+
+    append_run(dest, a->data + i, a_size - i);
+    append_run(dest, b->data + j, b_size - j);
+}
+
+void int_vector_difference(const IntVector *a, const IntVector *b, IntVector *dest)
+{
+    size_t a_size = a->offset;
+    size_t b_size = b->offset;
+    if (!set_destination(a, b, dest, a_size))
+        return;
+
+    LOG_INFO("Subtracting vector: %p from vector: %p into vector: %p...", (void *) b, (void *) a, (void *) dest);
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_size && j < b_size) {
+        if (a->data[i] < b->data[j]) {
+            size_t run = simd_skip_less(a->data + i, a_size - i, b->data[j]);
+            append_run(dest, a->data + i, run);
+            i += run;
+        } else if (b->data[j] < a->data[i]) {
+            j += simd_skip_less(b->data + j, b_size - j, a->data[i]);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+
+    append_run(dest, a->data + i, a_size - i);
+}
@@ -0,0 +1,178 @@
+#include "string_index.h"
+#include "logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRING_INDEX_MIN_CAPACITY 16
+#define STRING_INDEX_EMPTY ((size_t) -1)
+
+typedef struct {
+    uint64_t hash;
+    size_t position;
+} StringIndexSlot;
+
+struct StringVectorIndex {
+    StringIndexSlot *slots;
+    size_t capacity; // Always a power of two.
+    size_t count;
+};
+
+// Reads 8 bytes at a time, mixing each word in with a multiplication.
+static uint64_t string_hash(const char *value, size_t size)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = size * multiplier;
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, value + i, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, value + i, size - i);
+    hash = (hash ^ tail) * multiplier;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static size_t probe_distance(const StringVectorIndex *index, uint64_t hash, size_t slot)
+{
+    return (slot - (hash & (index->capacity - 1))) & (index->capacity - 1);
+}
+
+static bool string_index_allocate(StringVectorIndex *index, size_t capacity)
+{
+    index->slots = (StringIndexSlot *) malloc(capacity * sizeof(StringIndexSlot));
+    if (!index->slots) {
+        LOG_ERROR("There was an error while allocating %li slots for index: %p.", capacity, (void *) index);
+        return false;
+    }
+
+    for (size_t i = 0; i < capacity; ++i)
+        index->slots[i].position = STRING_INDEX_EMPTY;
+    index->capacity = capacity;
+    index->count = 0;
+    return true;
+}
+
+/* Robin Hood insertion: whoever is further away from its home slot keeps the slot,
+ * which keeps every probe sequence short and lets lookups stop early. */
+static void string_index_place(StringVectorIndex *index, StringIndexSlot slot)
+{
+    size_t mask = index->capacity - 1;
+    size_t i = slot.hash & mask;
+    size_t distance = 0;
+
+    for (;;) {
+        StringIndexSlot *current = &index->slots[i];
+        if (current->position == STRING_INDEX_EMPTY) {
+            *current = slot;
+            ++index->count;
+            return;
+        }
+
+        size_t current_distance = probe_distance(index, current->hash, i);
+        if (current_distance < distance) {
+            StringIndexSlot temp = *current;
+            *current = slot;
+            slot = temp;
+            distance = current_distance;
+        }
+
+        i = (i + 1) & mask;
+        ++distance;
+    }
+}
+
+// Hashes are kept in the slots, so growing never needs to look at the strings again.
+static bool string_index_grow(StringVectorIndex *index)
+{
+    StringIndexSlot *old_slots = index->slots;
+    size_t old_capacity = index->capacity;
+
+    LOG_INFO("Growing index: %p, old capacity: %li, new capacity: %li...", (void *) index, old_capacity, old_capacity * 2);
+
+    if (!string_index_allocate(index, old_capacity * 2)) {
+        index->slots = old_slots;
+        index->capacity = old_capacity;
+        return false;
+    }
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].position != STRING_INDEX_EMPTY)
+            string_index_place(index, old_slots[i]);
+    }
+
+    free(old_slots);
+    return true;
+}
+
+StringVectorIndex *string_index_new(size_t capacity)
+{
+    StringVectorIndex *index = (StringVectorIndex *) malloc(sizeof(StringVectorIndex));
+    if (!index) {
+        LOG_ERROR("There was an error while allocating a new index.");
+        return NULL;
+    }
+
+    // Keep the load factor under 7/8.
+    size_t slots = STRING_INDEX_MIN_CAPACITY;
+    while (slots - slots / 8 < capacity)
+        slots *= 2;
+
+    if (!string_index_allocate(index, slots)) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+void string_index_free(StringVectorIndex *index)
+{
+    if (!index)
+        return;
+    free(index->slots);
+    free(index);
+}
+
+static size_t string_index_lookup(const StringVectorIndex *index, const StringVector *vector, const char *value, size_t size, uint64_t hash)
+{
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+
+    for (size_t distance = 0;; ++distance) {
+        const StringIndexSlot *slot = &index->slots[i];
+        if (slot->position == STRING_INDEX_EMPTY || probe_distance(index, slot->hash, i) < distance)
+            return -1;
+
+        if (slot->hash == hash
+                && string_vector_get_size(vector, slot->position) == size
+                && memcmp(string_vector_get_at(vector, slot->position), value, size) == 0)
+            return slot->position;
+
+        i = (i + 1) & mask;
+    }
+}
+
+bool string_index_add(StringVectorIndex *index, const StringVector *vector, const char *value, size_t size, size_t position)
+{
+    uint64_t hash = string_hash(value, size);
+    if (string_index_lookup(index, vector, value, size, hash) != (size_t) -1)
+        return true;
+
+    if (index->count + 1 > index->capacity - index->capacity / 8 && !string_index_grow(index))
+        return false;
+
+    string_index_place(index, (StringIndexSlot) { hash, position });
+    return true;
+}
+
+size_t string_index_find(const StringVectorIndex *index, const StringVector *vector, const char *value, size_t size)
+{
+    return string_index_lookup(index, vector, value, size, string_hash(value, size));
+}
@@ -0,0 +1,18 @@
+#ifndef STRING_INDEX_H
+#define STRING_INDEX_H
+
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Open addressing hash table with Robin Hood probing, mapping the strings of a StringVector to their index.
+ * Only the hash and the index of each string are stored, strings are compared against the vector itself. */
+StringVectorIndex *string_index_new(size_t capacity);
+void string_index_free(StringVectorIndex *index);
+// Adds position as the index of value, unless value is already in the index. Returns false if there is no memory left.
+bool string_index_add(StringVectorIndex *index, const StringVector *vector, const char *value, size_t size, size_t position);
+// Returns the index of the first item equal to value, or -1 if there is none.
+size_t string_index_find(const StringVectorIndex *index, const StringVector *vector, const char *value, size_t size);
+
+#endif // STRING_INDEX_H
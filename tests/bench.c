@@ -0,0 +1,736 @@
+#include "packed.h"
+#include "segmented.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* Micro-benchmarks over increasing sizes. Every result is printed as a table and can be written as JSON
+ * with --json, then compared against a previous run with --baseline:
+ *
+ *     bench --max-size 1000000 --json baseline.json
+ *     bench --max-size 1000000 --baseline baseline.json --tolerance 10
+ *
+ * exits with 1 if any benchmark got slower than the baseline by more than the tolerance (percent). */
+
+#define MAX_RESULTS 1024
+#define NAME_SIZE 64
+// Small sizes are repeated until roughly this many operations are timed.
+#define TARGET_OPS 1000000
+// Every result is the median of this many timed runs, a single run varies too much to compare against a baseline.
+#define REPETITIONS 5
+
+typedef struct {
+    char name[NAME_SIZE];
+    size_t size;
+    double ns_per_op;
+    long bytes_allocated;
+    long peak_rss_kb;
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static size_t result_count;
+
+static struct timespec timer_start;
+static double elapsed_ns;
+static size_t ops;
+static long memory_start;
+static long memory_used;
+
+static long memory_in_use(void)
+{
+#ifdef __GLIBC__
+    return (long) mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static long peak_rss_kb(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Only the time between bench_start() and bench_stop() is measured, so setup and cleanup aren't.
+static void bench_start(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &timer_start);
+}
+
+static void bench_stop(size_t done)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns += (end.tv_sec - timer_start.tv_sec) * 1e9 + (end.tv_nsec - timer_start.tv_nsec);
+    ops += done;
+}
+
+// Called while the structure being measured is still alive, to record how much memory it takes.
+static void bench_memory(void)
+{
+    long used = memory_in_use() - memory_start;
+    if (used > memory_used)
+        memory_used = used;
+}
+
+static int *random_numbers(size_t size)
+{
+    int *numbers = (int *) malloc(size * sizeof(int));
+    for (size_t i = 0; i < size; ++i)
+        numbers[i] = rand() - rand();
+    return numbers;
+}
+
+static void make_key(char *key, size_t i)
+{
+    sprintf(key, "key-%zu", i * 2654435761u % 1000000007u);
+}
+
+static void bench_int_vector_add(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, -1);
+    bench_start();
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(&vector, (int) i);
+    bench_stop(size);
+    bench_memory();
+    int_vector_free(&vector);
+}
+
+static void bench_int_vector_add_array(size_t size)
+{
+    int chunk[256];
+    for (size_t i = 0; i < 256; ++i)
+        chunk[i] = (int) i;
+
+    IntVector vector;
+    int_vector_init(&vector, -1);
+    bench_start();
+    for (size_t i = 0; i < size; i += 256)
+        int_vector_add_array(&vector, chunk, size - i < 256 ? size - i : 256);
+    bench_stop(size);
+    bench_memory();
+    int_vector_free(&vector);
+}
+
+static void bench_int_vector_resize_shrink(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, size);
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(&vector, (int) i);
+
+    bench_start();
+    int_vector_resize(&vector, size);
+    int_vector_shrink(&vector);
+    bench_stop(2);
+    bench_memory();
+    int_vector_free(&vector);
+}
+
+static void bench_int_vector_copy(size_t size)
+{
+    IntVector source;
+    IntVector dest;
+    int_vector_init(&source, size);
+    int_vector_init(&dest, 1);
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(&source, (int) i);
+
+    bench_start();
+    int_vector_copy(&source, &dest);
+    bench_stop(size);
+    bench_memory();
+    int_vector_free(&source);
+    int_vector_free(&dest);
+}
+
+static void bench_int_vector_sort(size_t size)
+{
+    int *numbers = random_numbers(size);
+    IntVector vector;
+    int_vector_init(&vector, size);
+    int_vector_add_array(&vector, numbers, size);
+
+    bench_start();
+    int_vector_sort(&vector);
+    bench_stop(size);
+    bench_memory();
+    int_vector_free(&vector);
+    free(numbers);
+}
+
+static void bench_int_vector_sum(size_t size, enum SIMD_LEVEL level)
+{
+    int *numbers = random_numbers(size);
+    IntVector vector;
+    int_vector_init(&vector, size);
+    int_vector_add_array(&vector, numbers, size);
+
+    enum SIMD_LEVEL previous = simd_get_level();
+    simd_set_level(level);
+    volatile long long sum;
+    bench_start();
+    sum = int_vector_sum(&vector);
+    bench_stop(size);
+    simd_set_level(previous);
+    (void) sum;
+
+    int_vector_free(&vector);
+    free(numbers);
+}
+
+static void bench_int_vector_sum_scalar(size_t size)
+{
+    bench_int_vector_sum(size, SIMD_SCALAR);
+}
+
+static void bench_int_vector_sum_simd(size_t size)
+{
+    bench_int_vector_sum(size, SIMD_AVX512);
+}
+
+static void bench_int_vector_find(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, size);
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(&vector, (int) i);
+
+    volatile size_t pos;
+    bench_start();
+    pos = int_vector_find(&vector, -1);
+    bench_stop(size);
+    (void) pos;
+    int_vector_free(&vector);
+}
+
+static void bench_int_vector_contains(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, size);
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(&vector, (int) (i * 2));
+
+    size_t lookups = size < 1000 ? 1000 : size;
+    volatile size_t found = 0;
+    bench_start();
+    for (size_t i = 0; i < lookups; ++i)
+        found += int_vector_contains(&vector, (int) (i * 7 % (size * 2)));
+    bench_stop(lookups);
+    (void) found;
+    int_vector_free(&vector);
+}
+
+// Removes about 30% of the numbers, spread all over the vector.
+static void bench_int_vector_remove(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, size);
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(&vector, i % 10 < 3 ? -1 : (int) i);
+
+    volatile size_t removed;
+    bench_start();
+    removed = int_vector_remove(&vector, -1);
+    bench_stop(size);
+    (void) removed;
+    int_vector_free(&vector);
+}
+
+// Numbers of every length, negative ones included.
+static void fill_text_numbers(IntVector *vector, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        int_vector_add(vector, rand() - RAND_MAX / 2);
+}
+
+static void bench_int_vector_write_text(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, size);
+    fill_text_numbers(&vector, size);
+    FILE *file = tmpfile();
+
+    bench_start();
+    int_vector_write_text(&vector, fileno(file), ", ");
+    bench_stop(size);
+    fclose(file);
+    int_vector_free(&vector);
+}
+
+static void bench_int_vector_read_text(size_t size)
+{
+    IntVector vector;
+    int_vector_init(&vector, size);
+    fill_text_numbers(&vector, size);
+    FILE *file = tmpfile();
+    int_vector_write_text(&vector, fileno(file), ", ");
+    lseek(fileno(file), 0, SEEK_SET);
+    vector.offset = 0;
+
+    bench_start();
+    int_vector_read_text(&vector, fileno(file));
+    bench_stop(size);
+    fclose(file);
+    int_vector_free(&vector);
+}
+
+static void bench_int_vector_segmented_add(size_t size)
+{
+    SegmentedIntVector vector;
+    int_vector_segmented_init(&vector);
+    bench_start();
+    for (size_t i = 0; i < size; ++i)
+        int_vector_segmented_add(&vector, (int) i);
+    bench_stop(size);
+    bench_memory();
+    int_vector_segmented_free(&vector);
+}
+
+// Sorted IDs with small gaps, the case PACKED_DELTA is meant for.
+static int *sorted_ids(size_t size)
+{
+    int *ids = (int *) malloc(size * sizeof(int));
+    int id = 0;
+    for (size_t i = 0; i < size; ++i)
+        ids[i] = id += 1 + rand() % 16;
+    return ids;
+}
+
+static void bench_packed_int_vector_add_array(size_t size)
+{
+    int *ids = sorted_ids(size);
+    PackedIntVector vector;
+    packed_int_vector_init(&vector, PACKED_DELTA);
+
+    bench_start();
+    packed_int_vector_add_array(&vector, ids, size);
+    bench_stop(size);
+    bench_memory();
+    packed_int_vector_free(&vector);
+    free(ids);
+}
+
+static void bench_packed_int_vector_sum(size_t size)
+{
+    int *ids = sorted_ids(size);
+    PackedIntVector vector;
+    packed_int_vector_init(&vector, PACKED_DELTA);
+    packed_int_vector_add_array(&vector, ids, size);
+    free(ids);
+
+    volatile long long sum;
+    bench_start();
+    sum = packed_int_vector_sum(&vector);
+    bench_stop(size);
+    (void) sum;
+    packed_int_vector_free(&vector);
+}
+
+static void string_vector_fill(StringVector *vector, size_t size)
+{
+    char key[32];
+    for (size_t i = 0; i < size; ++i) {
+        make_key(key, i);
+        string_vector_add(vector, key);
+    }
+}
+
+/* Formats size keys before timing starts, so sprintf() isn't part of what's measured.
+ * Keys live in the same block as the array pointing to them, a single free() releases both. */
+static const char **make_keys(size_t size)
+{
+    const char **values = (const char **) malloc(size * (sizeof(char *) + 32));
+    char (*keys)[32] = (char (*)[32]) (values + size);
+    for (size_t i = 0; i < size; ++i) {
+        make_key(keys[i], i);
+        values[i] = keys[i];
+    }
+    // The keys aren't part of the vector, so they aren't counted in its memory either.
+    memory_start = memory_in_use();
+    return values;
+}
+
+static void bench_string_vector_add_keys(size_t size, bool arena)
+{
+    const char **keys = make_keys(size);
+    StringVector vector;
+    if (arena)
+        string_vector_init_arena(&vector, -1, -1);
+    else
+        string_vector_init(&vector, -1, -1);
+
+    bench_start();
+    for (size_t i = 0; i < size; ++i)
+        string_vector_add(&vector, keys[i]);
+    bench_stop(size);
+    bench_memory();
+    string_vector_free(&vector);
+    free(keys);
+}
+
+static void bench_string_vector_add(size_t size)
+{
+    bench_string_vector_add_keys(size, false);
+}
+
+static void bench_string_vector_add_arena(size_t size)
+{
+    bench_string_vector_add_keys(size, true);
+}
+
+static void bench_string_vector_add_array(size_t size)
+{
+    const char **keys = make_keys(size);
+    StringVector vector;
+    string_vector_init_arena(&vector, -1, -1);
+    bench_start();
+    string_vector_add_array(&vector, keys, size);
+    bench_stop(size);
+    bench_memory();
+    string_vector_free(&vector);
+    free(keys);
+}
+
+static void bench_string_vector_resize(size_t size)
+{
+    StringVector vector;
+    string_vector_init(&vector, size, -1);
+    string_vector_fill(&vector, size);
+
+    bench_start();
+    string_vector_resize(&vector, size);
+    string_vector_shrink(&vector);
+    bench_stop(2);
+    bench_memory();
+    string_vector_free(&vector);
+}
+
+static void bench_string_vector_shrink_items(size_t size)
+{
+    StringVector vector;
+    string_vector_init(&vector, size, 32);
+    string_vector_fill(&vector, size);
+
+    bench_start();
+    string_vector_shrink_items(&vector);
+    bench_stop(size);
+    bench_memory();
+    string_vector_free(&vector);
+}
+
+static void bench_string_vector_find(size_t size, bool index)
+{
+    StringVector vector;
+    string_vector_init_arena(&vector, size, -1);
+    string_vector_fill(&vector, size);
+    if (index)
+        string_vector_enable_index(&vector);
+
+    // Linear scans are O(size) each, so they get fewer lookups, spread over the whole vector.
+    size_t lookups = index ? (size < 1000 ? 1000 : size) : 16;
+    size_t stride = index || size < lookups ? 1 : size / lookups;
+    char key[32];
+    volatile size_t found = 0;
+    bench_start();
+    for (size_t i = 0; i < lookups; ++i) {
+        make_key(key, i * stride % size);
+        found += string_vector_find(&vector, key) != (size_t) -1;
+    }
+    bench_stop(lookups);
+    bench_memory();
+    (void) found;
+    string_vector_free(&vector);
+}
+
+static void bench_string_vector_find_indexed(size_t size)
+{
+    bench_string_vector_find(size, true);
+}
+
+static void bench_string_vector_find_linear(size_t size)
+{
+    bench_string_vector_find(size, false);
+}
+
+// Searches every string for a needle none of them holds, in one pass over the arena or string by string.
+static void bench_string_vector_find_substring(size_t size, bool arena)
+{
+    StringVector vector;
+    if (arena)
+        string_vector_init_arena(&vector, size, -1);
+    else
+        string_vector_init(&vector, size, -1);
+    string_vector_fill(&vector, size);
+
+    volatile size_t found;
+    bench_start();
+    found = string_vector_find_substring(&vector, 0, "key-x");
+    bench_stop(size);
+    (void) found;
+    string_vector_free(&vector);
+}
+
+static void bench_string_vector_find_substring_arena(size_t size)
+{
+    bench_string_vector_find_substring(size, true);
+}
+
+static void bench_string_vector_find_substring_items(size_t size)
+{
+    bench_string_vector_find_substring(size, false);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(size_t size);
+    // Sizes past this one are skipped, 0 means no limit.
+    size_t max_size;
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    { "int_vector_add", bench_int_vector_add, 0 },
+    { "int_vector_add_array", bench_int_vector_add_array, 0 },
+    { "int_vector_resize_shrink", bench_int_vector_resize_shrink, 0 },
+    { "int_vector_copy", bench_int_vector_copy, 0 },
+    { "int_vector_sort", bench_int_vector_sort, 0 },
+    { "int_vector_sum_scalar", bench_int_vector_sum_scalar, 0 },
+    { "int_vector_sum_simd", bench_int_vector_sum_simd, 0 },
+    { "int_vector_find", bench_int_vector_find, 0 },
+    { "int_vector_contains", bench_int_vector_contains, 0 },
+    { "int_vector_remove", bench_int_vector_remove, 0 },
+    { "int_vector_write_text", bench_int_vector_write_text, 0 },
+    { "int_vector_read_text", bench_int_vector_read_text, 0 },
+    { "int_vector_segmented_add", bench_int_vector_segmented_add, 0 },
+    { "packed_int_vector_add_array", bench_packed_int_vector_add_array, 0 },
+    { "packed_int_vector_sum", bench_packed_int_vector_sum, 0 },
+    { "string_vector_add", bench_string_vector_add, 10000000 },
+    { "string_vector_add_arena", bench_string_vector_add_arena, 10000000 },
+    { "string_vector_add_array", bench_string_vector_add_array, 10000000 },
+    { "string_vector_resize_shrink", bench_string_vector_resize, 10000000 },
+    { "string_vector_shrink_items", bench_string_vector_shrink_items, 10000000 },
+    { "string_vector_find_indexed", bench_string_vector_find_indexed, 10000000 },
+    { "string_vector_find_linear", bench_string_vector_find_linear, 1000000 },
+    { "string_vector_find_substring_arena", bench_string_vector_find_substring_arena, 10000000 },
+    { "string_vector_find_substring_items", bench_string_vector_find_substring_items, 10000000 },
+};
+
+// Returns the ns per operation of a single timed run.
+static double measure(const Benchmark *benchmark, size_t size)
+{
+    elapsed_ns = 0;
+    ops = 0;
+
+    size_t repeat = size < TARGET_OPS ? TARGET_OPS / size : 1;
+    if (repeat > 1000)
+        repeat = 1000;
+    for (size_t i = 0; i < repeat; ++i)
+        benchmark->run(size);
+    return ops ? elapsed_ns / ops : 0;
+}
+
+static int compare_times(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static void measure_result(const Benchmark *benchmark, size_t size, BenchResult *result)
+{
+    memory_used = 0;
+    memory_start = memory_in_use();
+
+    double times[REPETITIONS];
+    for (size_t i = 0; i < REPETITIONS; ++i)
+        times[i] = measure(benchmark, size);
+    qsort(times, REPETITIONS, sizeof(double), compare_times);
+
+    result->ns_per_op = times[REPETITIONS / 2];
+    result->bytes_allocated = memory_used;
+    result->peak_rss_kb = peak_rss_kb();
+}
+
+/* Every benchmark and size runs in a child process of its own, so its peak RSS is its own rather than the highest
+ * one of everything run before it. The child sends its result back through a pipe. */
+static void run_benchmark(const Benchmark *benchmark, size_t size)
+{
+    if (result_count == MAX_RESULTS)
+        return;
+
+    BenchResult *result = &results[result_count];
+    snprintf(result->name, NAME_SIZE, "%s", benchmark->name);
+    result->size = size;
+
+    int fds[2];
+    pid_t child = -1;
+    if (pipe(fds) == 0) {
+        child = fork();
+        if (child < 0) {
+            close(fds[0]);
+            close(fds[1]);
+        }
+    }
+
+    if (child == 0) {
+        close(fds[0]);
+        measure_result(benchmark, size, result);
+        bool sent = write(fds[1], result, sizeof(*result)) == (ssize_t) sizeof(*result);
+        _exit(sent ? 0 : 1);
+    }
+
+    if (child < 0) {
+        // Without a child process the peak RSS is the one of the whole program.
+        measure_result(benchmark, size, result);
+    } else {
+        close(fds[1]);
+        bool received = read(fds[0], result, sizeof(*result)) == (ssize_t) sizeof(*result);
+        close(fds[0]);
+        waitpid(child, NULL, 0);
+        if (!received) {
+            fprintf(stderr, "Benchmark %s failed at size %zu.\n", benchmark->name, size);
+            return;
+        }
+    }
+
+    ++result_count;
+    printf("%-30s %12zu %12.2f %14li %12li\n",
+           result->name, result->size, result->ns_per_op, result->bytes_allocated, result->peak_rss_kb);
+    fflush(stdout);
+}
+
+static bool write_json(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "Couldn't open %s for writing.\n", path);
+        return false;
+    }
+
+    // One result per line, so read_baseline() doesn't need a full JSON parser.
+    fprintf(fp, "{\n  \"simd_level\": \"%s\",\n  \"results\": [\n", simd_level_name(simd_get_level()));
+    for (size_t i = 0; i < result_count; ++i) {
+        fprintf(fp,
+                "    {\"name\": \"%s\", \"size\": %zu, \"ns_per_op\": %.3f, \"bytes_allocated\": %li, \"peak_rss_kb\": %li}%s\n",
+                results[i].name, results[i].size, results[i].ns_per_op,
+                results[i].bytes_allocated, results[i].peak_rss_kb,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+// Returns how many benchmarks got slower than the baseline by more than tolerance percent, or -1 on error.
+static int compare_baseline(const char *path, double tolerance)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Couldn't open baseline %s.\n", path);
+        return -1;
+    }
+
+    int regressions = 0;
+    char line[512];
+    printf("\n%-30s %12s %12s %12s %8s\n", "benchmark", "size", "baseline", "current", "change");
+
+    while (fgets(line, sizeof(line), fp)) {
+        char name[NAME_SIZE];
+        size_t size;
+        double baseline;
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"size\": %zu, \"ns_per_op\": %lf", name, &size, &baseline) != 3)
+            continue;
+
+        for (size_t i = 0; i < result_count; ++i) {
+            if (strcmp(results[i].name, name) != 0 || results[i].size != size)
+                continue;
+
+            double change = baseline > 0 ? (results[i].ns_per_op - baseline) / baseline * 100 : 0;
+            bool regressed = change > tolerance;
+            regressions += regressed;
+            printf("%-30s %12zu %12.2f %12.2f %+7.1f%%%s\n",
+                   name, size, baseline, results[i].ns_per_op, change, regressed ? " REGRESSION" : "");
+        }
+    }
+
+    fclose(fp);
+    return regressions;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [--max-size N] [--filter NAME] [--json PATH] [--baseline PATH] [--tolerance PERCENT]\n",
+            program);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_size = 1000000;
+    const char *filter = NULL;
+    const char *json = NULL;
+    const char *baseline = NULL;
+    double tolerance = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--max-size") == 0) {
+            max_size = strtoull(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            json = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--baseline") == 0) {
+            baseline = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--tolerance") == 0) {
+            tolerance = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    srand(42);
+    printf("SIMD level: %s\n\n", simd_level_name(simd_get_level()));
+    printf("%-30s %12s %12s %14s %12s\n", "benchmark", "size", "ns/op", "bytes", "peak rss kb");
+
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i) {
+        const Benchmark *benchmark = &benchmarks[i];
+        if (filter && !strstr(benchmark->name, filter))
+            continue;
+
+        for (size_t size = 10; size <= max_size; size *= 10) {
+            if (benchmark->max_size && size > benchmark->max_size)
+                break;
+            run_benchmark(benchmark, size);
+        }
+    }
+
+    if (json && !write_json(json))
+        return 2;
+
+    if (baseline) {
+        int regressions = compare_baseline(baseline, tolerance);
+        if (regressions < 0)
+            return 2;
+        if (regressions > 0) {
+            printf("\n%i benchmarks regressed by more than %.1f%%.\n", regressions, tolerance);
+            return 1;
+        }
+    }
+
+    return 0;
+}
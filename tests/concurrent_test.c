@@ -0,0 +1,119 @@
+#include "concurrent.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Stress test for ConcurrentIntVector, meant to be run under ThreadSanitizer as well:
+ *
+ *     concurrent_test [threads] [numbers per thread]
+ *
+ * Every writer pushes its own numbers while a reader keeps publishing and checking what it sees.
+ * Afterwards every number must be there exactly once. */
+
+typedef struct {
+    ConcurrentIntVector *vector;
+    int first;
+    int count;
+} Writer;
+
+static atomic_bool writing;
+
+// Odd writers push one number at a time, even ones in batches of different sizes.
+static void *write_numbers(void *arg)
+{
+    Writer *writer = (Writer *) arg;
+    if (writer->first / writer->count % 2) {
+        for (int i = 0; i < writer->count; ++i)
+            int_vector_concurrent_push(writer->vector, writer->first + i);
+        return NULL;
+    }
+
+    int batch[100];
+    for (int i = 0; i < writer->count;) {
+        int size = 1 + i % 100;
+        if (size > writer->count - i)
+            size = writer->count - i;
+        for (int j = 0; j < size; ++j)
+            batch[j] = writer->first + i + j;
+        int_vector_concurrent_push_array(writer->vector, batch, size);
+        i += size;
+    }
+    return NULL;
+}
+
+static void *read_numbers(void *arg)
+{
+    ConcurrentIntVector *vector = (ConcurrentIntVector *) arg;
+    size_t checked = 0;
+    long long sum = 0;
+
+    while (atomic_load(&writing)) {
+        size_t size = int_vector_concurrent_publish(vector);
+        for (; checked < size; ++checked)
+            sum += *int_vector_concurrent_at(vector, checked);
+    }
+
+    printf("Reader saw %li numbers while writers were running (sum: %lli).\n", checked, sum);
+    return NULL;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+    return (*(const int *) a > *(const int *) b) - (*(const int *) a < *(const int *) b);
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = argc > 1 ? atoi(argv[1]) : 8;
+    int count = argc > 2 ? atoi(argv[2]) : 100000;
+    if (threads <= 0 || count <= 0) {
+        fprintf(stderr, "Usage: %s [threads] [numbers per thread]\n", argv[0]);
+        return 1;
+    }
+
+    ConcurrentIntVector vector;
+    int_vector_concurrent_init(&vector);
+
+    pthread_t *ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+    Writer *writers = (Writer *) malloc(threads * sizeof(Writer));
+    pthread_t reader;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    atomic_store(&writing, true);
+    pthread_create(&reader, NULL, read_numbers, &vector);
+    for (int i = 0; i < threads; ++i) {
+        writers[i] = (Writer) { .vector = &vector, .first = i * count, .count = count };
+        pthread_create(&ids[i], NULL, write_numbers, &writers[i]);
+    }
+    for (int i = 0; i < threads; ++i)
+        pthread_join(ids[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    atomic_store(&writing, false);
+    pthread_join(reader, NULL);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%i threads pushed %i numbers each in %.3f s (%.1f M pushes/s).\n",
+           threads, count, seconds, threads * (double) count / seconds / 1e6);
+
+    IntVector snapshot;
+    int_vector_init(&snapshot, -1);
+    size_t size = int_vector_concurrent_snapshot(&vector, &snapshot);
+
+    qsort(snapshot.data, snapshot.offset, sizeof(int), compare_ints);
+    bool valid = size == (size_t) threads * count;
+    for (size_t i = 0; valid && i < snapshot.offset; ++i)
+        valid = snapshot.data[i] == (int) i;
+
+    printf("Snapshot holds %li numbers: %s\n", size, valid ? "OK" : "FAILED");
+
+    int_vector_free(&snapshot);
+    int_vector_concurrent_free(&vector);
+    free(ids);
+    free(writers);
+    return valid ? 0 : 1;
+}
@@ -1,8 +1,14 @@
+#include "packed.h"
 #include "vector.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+static int add_numbers(int a, int b, void *context)
+{
+    return a + b;
+}
+
 int main(int argc, char *argv[])
 {
     printf("Testing functionality...\n\n");
@@ -43,6 +49,104 @@ int main(int argc, char *argv[])
     printf("\nValue at index %li of numbers vector: %i\n", numbers.size, int_vector_get_at(&numbers, numbers.size));
     printf("\nLast number of numbers vector: %i\n", int_vector_get_last(&numbers));
 
+    printf("\nSum: %lli, min: %i, max: %i\n", int_vector_sum(&numbers), int_vector_min(&numbers), int_vector_max(&numbers));
+    printf("Times 50 is in numbers vector: %li, index of 150: %li\n", int_vector_count(&numbers, 50), int_vector_find(&numbers, 150));
+
+    int unsorted[] = { 42, -7, 1000000, 0, -2147483647, 13, 42, 8 };
+    IntVector to_sort;
+    int_vector_init(&to_sort, 8);
+    int_vector_add_array(&to_sort, unsorted, 8);
+    int_vector_sort(&to_sort);
+    printf("\nSorted vector:\n");
+    int_vector_print(&to_sort);
+    printf("Lower bound of 42: %li, contains 9: %i\n", int_vector_lower_bound(&to_sort, 42), int_vector_contains(&to_sort, 9));
+
+    int_vector_insert_at(&to_sort, 2, 42);
+    int_vector_erase_at(&to_sort, 0);
+    printf("\nRemoved %li times 42 after inserting it once more:\n", int_vector_remove(&to_sort, 42));
+    int_vector_print(&to_sort);
+
+    IntVectorView middle = int_vector_view_slice(int_vector_view(&to_sort), 1, 4);
+    printf("\nSum of sorted numbers 1 to 3: %lli, every other one contains 13: %i\n",
+           int_vector_view_sum(middle), int_vector_view_contains(int_vector_view_stride(middle, 2), 13));
+
+    IntVector common;
+    int_vector_init(&common, -1);
+    int_vector_intersect(&to_sort, &numbers, &common);
+    printf("\nIn both sorted vector and numbers vector:\n");
+    int_vector_print(&common);
+    int_vector_free(&common);
+
+    IntVector mapped;
+    if (int_vector_save(&to_sort, "int_test.vector") && int_vector_open_mmap(&mapped, "int_test.vector")) {
+        printf("\nSaved file is valid: %i, mapped vector:\n", int_vector_verify_file("int_test.vector"));
+        int_vector_print(&mapped);
+        int_vector_add(&mapped, 2024);
+        int_vector_print(&mapped);
+        int_vector_free(&mapped);
+        remove("int_test.vector");
+    }
+
+    FILE *text = tmpfile();
+    IntVector parsed;
+    int_vector_init(&parsed, -1);
+    if (text && int_vector_write_text(&to_sort, fileno(text), " ") && fseek(text, 0, SEEK_SET) == 0
+            && int_vector_read_text(&parsed, fileno(text))) {
+        printf("\nSorted vector read back from text:\n");
+        int_vector_print(&parsed);
+    }
+    int_vector_free(&parsed);
+    if (text)
+        fclose(text);
+    int_vector_free(&to_sort);
+
+    ArenaAllocator request_arena;
+    arena_allocator_init(&request_arena, -1);
+    IntVector request_numbers;
+    int_vector_init(&request_numbers, -1);
+    int_vector_set_allocator(&request_numbers, &request_arena.allocator);
+    int_vector_add_array(&request_numbers, other_numbers, 14);
+    printf("\nVector (Arena allocated):\n");
+    int_vector_print(&request_numbers);
+    // Everything taken from the arena is given back at once.
+    arena_allocator_free(&request_arena);
+
+    IntVector ones;
+    int_vector_init(&ones, -1);
+    int_vector_parallel_fill(&ones, 1, 100000, NULL);
+    printf("\nSum of %li ones added up in parallel: %i\n", ones.offset, int_vector_parallel_reduce(&ones, 0, add_numbers, NULL, NULL));
+
+    IntVector taken;
+    int_vector_init(&taken, -1);
+    int_vector_move(&ones, &taken);
+    size_t taken_size;
+    int *taken_numbers = int_vector_release(&taken, &taken_size);
+    printf("Took %li numbers out of the vector without copying them, first one: %i\n", taken_size, taken_numbers[0]);
+    free(taken_numbers);
+
+    IntVector ids;
+    int_vector_init(&ids, -1);
+    for (int i = 0; i < 1000; ++i)
+        int_vector_add(&ids, 1000000 + i * 3);
+    PackedIntVector packed;
+    packed_int_vector_pack(&packed, &ids, PACKED_DELTA);
+    printf("\n%li sorted IDs packed into %li bytes instead of %li, ID 500: %i, sum: %lli\n",
+           packed.size, packed_int_vector_memory(&packed), ids.offset * sizeof(int),
+           packed_int_vector_get_at(&packed, 500), packed_int_vector_sum(&packed));
+    packed_int_vector_free(&packed);
+    int_vector_free(&ids);
+
+    VectorStats stats = { 0 };
+    IntVector counted;
+    int_vector_init(&counted, 1);
+    int_vector_set_stats(&counted, &stats);
+    for (int i = 0; i < 1000; ++i)
+        int_vector_add(&counted, i);
+    int_vector_stats(&counted, &stats);
+    printf("\nStatistics of a vector which grew to 1000 numbers:\n");
+    vector_stats_write_prometheus(stdout, &stats, "vector=\"counted\"");
+    int_vector_free(&counted);
+
     int_vector_free(&numbers);
     int_vector_free(&numbers_copy);
 
@@ -1,3 +1,4 @@
+#include "segmented.h"
 #include "vector.h"
 
 int main(int argc, char *argv[])
@@ -27,4 +28,56 @@ int main(int argc, char *argv[])
     printf("Items in vector: %li\n\n", names.offset);
 
     string_vector_free(&names);
+
+    StringVector arena_names;
+    string_vector_init_arena(&arena_names, 2, 8);
+
+    string_vector_add(&arena_names, "John");
+    string_vector_add(&arena_names, "Alice");
+    string_vector_add(&arena_names, "Bob");
+
+    printf("\nVector (Arena):\n");
+    string_vector_print(&arena_names);
+    printf("\n");
+
+    printf("Vector size: %li\n", arena_names.vector_size);
+    printf("Items in vector: %li\n", arena_names.offset);
+    printf("Last item in vector: %s\n\n", string_vector_get_last(&arena_names));
+
+    string_vector_enable_index(&arena_names);
+    string_vector_add(&arena_names, "Carol");
+    printf("Index of Alice: %li, index of Carol: %li\n\n", string_vector_find(&arena_names, "Alice"), string_vector_find(&arena_names, "Carol"));
+    printf(
+        "First name containing \"ro\": %li, Carol starts with \"Ca\": %i, last name is Carol: %i\n\n",
+        string_vector_find_substring(&arena_names, 0, "ro"),
+        string_vector_starts_with(&arena_names, arena_names.offset - 1, "Ca"),
+        string_vector_equals(&arena_names, arena_names.offset - 1, "Carol")
+    );
+
+    StringVectorView every_other = string_vector_view_stride(string_vector_view(&arena_names), 2);
+    printf("Every other name: %li names, the second one is: %s\n\n", every_other.size, string_vector_view_get_at(every_other, 1));
+
+    string_vector_shrink(&arena_names);
+    printf("Arena size after shrinking: %li\n\n", arena_names.arena_size);
+
+    StringVector saved_names;
+    if (string_vector_save(&arena_names, "string_test.svector") && string_vector_open_mmap(&saved_names, "string_test.svector")) {
+        printf("\nVector (Mapped from file):\n");
+        string_vector_print(&saved_names);
+        string_vector_add(&saved_names, "Dave");
+        printf("Last item after adding to it: %s\n\n", string_vector_get_last(&saved_names));
+        string_vector_free(&saved_names);
+        remove("string_test.svector");
+    }
+
+    string_vector_free(&arena_names);
+
+    SegmentedStringVector stable_names;
+    string_vector_segmented_init(&stable_names, -1);
+    string_vector_segmented_add(&stable_names, "Alice");
+    char *alice = string_vector_segmented_get_at(&stable_names, 0);
+    for (int i = 0; i < 10000; ++i)
+        string_vector_segmented_add(&stable_names, "Bob");
+    printf("\nFirst name still at the same place after adding %li more: %s\n", string_vector_segmented_size(&stable_names) - 1, alice);
+    string_vector_segmented_free(&stable_names);
 }
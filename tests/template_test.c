@@ -0,0 +1,47 @@
+#include "vector_template.h"
+
+#include <stdio.h>
+
+typedef struct {
+    double x;
+    double y;
+} Point;
+
+VECTOR_DEFINE(DoubleVector, double_vector, double)
+VECTOR_DEFINE(PointVector, point_vector, Point)
+
+int main(int argc, char *argv[])
+{
+    set_log_level(INFO);
+    DoubleVector numbers;
+    double_vector_init(&numbers, 2);
+
+    double_vector_add(&numbers, 1.5);
+    double_vector_add(&numbers, 2.5);
+    double_vector_add(&numbers, 3.5);
+
+    printf("\nVector:\n");
+    for (size_t i = 0; i < numbers.offset; ++i)
+        printf("%g%s", *double_vector_at(&numbers, i), (i == numbers.offset - 1 ? "\n" : ", "));
+
+    double last = 0;
+    double_vector_pop(&numbers, &last);
+    printf("\nPopped: %g, items in vector: %li\n\n", last, numbers.offset);
+
+    PointVector points;
+    point_vector_init(&points, -1);
+    for (size_t i = 0; i < 15; ++i)
+        point_vector_add(&points, (Point) { i, i * 2.0 });
+
+    PointVector points_copy;
+    point_vector_init(&points_copy, 0);
+    point_vector_copy(&points, &points_copy);
+    point_vector_shrink(&points_copy);
+
+    Point *point = point_vector_at(&points_copy, 14);
+    printf("\nPoint at index 14 of copy: (%g, %g), copy size: %li\n", point->x, point->y, points_copy.size);
+
+    double_vector_free(&numbers);
+    point_vector_free(&points);
+    point_vector_free(&points_copy);
+}
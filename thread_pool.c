@@ -0,0 +1,261 @@
+#include "thread_pool.h"
+#include "logger.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// What is left of the range of one thread. Each one takes a cache line of its own.
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock;
+    size_t begin;
+    size_t end;
+} ThreadPoolRange;
+
+struct ThreadPool {
+    size_t threads;
+    pthread_t *ids;
+    ThreadPoolRange *ranges;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    // Bumped for every job, workers sleep until it changes.
+    size_t generation;
+    size_t running;
+    bool stopping;
+
+    ThreadPoolTask task;
+    void *context;
+    size_t grain;
+    // Taken for the whole length of a job, so only one runs at a time.
+    pthread_mutex_t job;
+};
+
+typedef struct {
+    ThreadPool *pool;
+    size_t id;
+} ThreadPoolWorker;
+
+static size_t align_split(size_t index, size_t end)
+{
+    index = (index + THREAD_POOL_SPLIT_ALIGN - 1) / THREAD_POOL_SPLIT_ALIGN * THREAD_POOL_SPLIT_ALIGN;
+    return index < end ? index : end;
+}
+
+// Takes the next chunk from the range of thread id. Returns false if it's empty.
+static bool take_chunk(ThreadPool *pool, size_t id, size_t *begin, size_t *end)
+{
+    ThreadPoolRange *range = &pool->ranges[id];
+    pthread_mutex_lock(&range->lock);
+    bool found = range->begin < range->end;
+    if (found) {
+        *begin = range->begin;
+        *end = range->end - range->begin > pool->grain ? range->begin + pool->grain : range->end;
+        range->begin = *end;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return found;
+}
+
+/* Moves the second half of what is left of another thread's range to the range of thread id,
+ * or all of it when it's no bigger than a chunk. Returns false if every range is empty. */
+static bool steal(ThreadPool *pool, size_t id)
+{
+    for (size_t i = 1; i < pool->threads; ++i) {
+        ThreadPoolRange *victim = &pool->ranges[(id + i) % pool->threads];
+        pthread_mutex_lock(&victim->lock);
+        if (victim->begin >= victim->end) {
+            pthread_mutex_unlock(&victim->lock);
+            continue;
+        }
+
+        size_t begin = victim->begin;
+        if (victim->end - victim->begin > pool->grain)
+            begin = align_split(victim->begin + (victim->end - victim->begin) / 2, victim->end);
+        size_t end = victim->end;
+        victim->end = begin;
+        pthread_mutex_unlock(&victim->lock);
+
+        ThreadPoolRange *range = &pool->ranges[id];
+        pthread_mutex_lock(&range->lock);
+        range->begin = begin;
+        range->end = end;
+        pthread_mutex_unlock(&range->lock);
+        return true;
+    }
+    return false;
+}
+
+static void work(ThreadPool *pool, size_t id)
+{
+    size_t begin;
+    size_t end;
+    do {
+        while (take_chunk(pool, id, &begin, &end))
+            pool->task(begin, end, id, pool->context);
+    } while (steal(pool, id));
+}
+
+static void *thread_pool_worker(void *arg)
+{
+    ThreadPoolWorker *worker = (ThreadPoolWorker *) arg;
+    ThreadPool *pool = worker->pool;
+    size_t id = worker->id;
+    free(worker);
+
+    size_t generation = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == generation && !pool->stopping)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        work(pool, id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+ThreadPool *thread_pool_new(size_t threads)
+{
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? cpus : 1;
+    }
+
+    LOG_INFO("Creating thread pool with %li threads...", threads);
+
+    ThreadPool *pool = (ThreadPool *) calloc(1, sizeof(ThreadPool));
+    if (pool) {
+        pool->ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+        pool->ranges = (ThreadPoolRange *) aligned_alloc(64, threads * sizeof(ThreadPoolRange));
+    }
+    if (!pool || !pool->ids || !pool->ranges) {
+        LOG_ERROR("There was an error while allocating a thread pool with %li threads.", threads);
+        if (pool) {
+            free(pool->ids);
+            free(pool->ranges);
+        }
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->job, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (size_t i = 0; i < threads; ++i)
+        pthread_mutex_init(&pool->ranges[i].lock, NULL);
+
+    // The calling thread is worker 0, so only threads - 1 are started.
+    pool->threads = 1;
+    while (pool->threads < threads) {
+        ThreadPoolWorker *worker = (ThreadPoolWorker *) malloc(sizeof(ThreadPoolWorker));
+        if (!worker)
+            break;
+        worker->pool = pool;
+        worker->id = pool->threads;
+        if (pthread_create(&pool->ids[pool->threads], NULL, thread_pool_worker, worker) != 0) {
+            free(worker);
+            break;
+        }
+        ++pool->threads;
+    }
+
+    if (pool->threads < threads)
+        LOG_WARN("Could only start %li threads for thread pool: %p.", pool->threads, (void *) pool);
+
+    return pool;
+}
+
+void thread_pool_free(ThreadPool *pool)
+{
+    if (!pool)
+        return;
+
+    LOG_INFO("Freeing thread pool: %p.", (void *) pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 1; i < pool->threads; ++i)
+        pthread_join(pool->ids[i], NULL);
+    for (size_t i = 0; i < pool->threads; ++i)
+        pthread_mutex_destroy(&pool->ranges[i].lock);
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->job);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->ids);
+    free(pool->ranges);
+    free(pool);
+}
+
+size_t thread_pool_size(const ThreadPool *pool)
+{
+    return pool->threads;
+}
+
+static ThreadPool *default_pool;
+static pthread_once_t default_pool_once = PTHREAD_ONCE_INIT;
+
+static void default_pool_create(void)
+{
+    default_pool = thread_pool_new(0);
+}
+
+ThreadPool *thread_pool_default(void)
+{
+    pthread_once(&default_pool_once, default_pool_create);
+    return default_pool;
+}
+
+void thread_pool_run(ThreadPool *pool, size_t size, size_t grain, ThreadPoolTask task, void *context)
+{
+    if (grain == 0)
+        grain = 1;
+
+    // Not worth waking anybody up for a single chunk.
+    if (pool->threads == 1 || size <= grain) {
+        if (size > 0)
+            task(0, size, 0, context);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->job);
+
+    for (size_t i = 0; i < pool->threads; ++i) {
+        pool->ranges[i].begin = align_split(size / pool->threads * i, size);
+        pool->ranges[i].end = i + 1 < pool->threads ? align_split(size / pool->threads * (i + 1), size) : size;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->grain = grain;
+    pool->running = pool->threads - 1;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->job);
+}
@@ -0,0 +1,29 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "vector.h"
+
+#include <stddef.h>
+
+/* Range indices handed to tasks are split at multiples of this, 64 bytes worth of ints, so ranges are whole cache lines
+ * of ints past the start of the data. That only lines up with actual cache lines when the data starts on a 64-byte
+ * boundary: IntVector memory from malloc() is only 16-byte aligned, so neighbouring ranges may still share the one line
+ * around each split. The pool only sees indices, not addresses, so it can't do better. */
+#define THREAD_POOL_SPLIT_ALIGN 16
+
+// Called with a range [begin, end) of the work and the id of the thread running it, from 0 to threads - 1.
+typedef void (*ThreadPoolTask)(size_t begin, size_t end, size_t worker, void *context);
+
+/* Pool of threads sharing out ranges of indices. Every thread starts with an even part of the range and works
+ * through it grain indices at a time, threads running out of work steal half of what another one has left.
+ * threads is the amount of threads working including the calling one, 0 means one per CPU. */
+ThreadPool *thread_pool_new(size_t threads);
+void thread_pool_free(ThreadPool *pool);
+size_t thread_pool_size(const ThreadPool *pool);
+// Pool shared by the parallel algorithms when they aren't given one, with one thread per CPU.
+ThreadPool *thread_pool_default(void);
+/* Runs task over [0, size) and returns once all of it is done. The calling thread takes part as worker 0.
+ * Jobs on the same pool run one after another, so task must not run jobs on pool itself. */
+void thread_pool_run(ThreadPool *pool, size_t size, size_t grain, ThreadPoolTask task, void *context);
+
+#endif // THREAD_POOL_H
@@ -1,367 +1,551 @@
 #include "vector.h"
 #include "logger.h"
+#include "simd.h"
+#include "string_index.h"
 
 #include <stdlib.h>
-
-bool debug = false;
+#include <string.h>
 
 void set_debug(bool value)
 {
-    debug = value;
+    set_log_level(value ? INFO : ERROR);
 }
 
-static void int_vector_memset(IntVector *vector, int value, size_t start)
-{
-    if (!vector->data) {
-        logger(ERROR, debug, __func__, "Vector is NOT properly initialized.");
-        return;
-    }
+VECTOR_IMPLEMENT(, IntVector, int_vector, int)
 
-    logger(
-        INFO, debug, __func__,
-        "Setting value %i to vector: %p starting from: %li...",
-        value, vector, start
-    );
+void int_vector_print(const IntVector *vector)
+{
+    // Written straight to the file descriptor a buffer at a time, so whatever stdout holds must go first.
+    fflush(stdout);
+    int_vector_write_text(vector, fileno(stdout), ", ");
+}
 
-    for (size_t i = start; i < vector->size; ++i)
-        vector->data[i] = value;
+int int_vector_get_at(const IntVector *vector, size_t index)
+{
+    const int *value = int_vector_at(vector, index);
+    return value ? *value : -1;
+}
 
-    logger(INFO, debug, __func__, "Memory set.");
+int int_vector_get_last(const IntVector *vector)
+{
+    return int_vector_get_at(vector, vector->offset - 1);
 }
 
-static void int_vector_allocate(IntVector *vector)
+long long int_vector_sum(const IntVector *vector)
 {
-    logger(
-        INFO, debug, __func__,
-        "Allocating memory to be able to hold %li numbers in vector: %p...",
-        vector->size, vector
-    );
+    return simd_sum(vector->data, vector->offset);
+}
 
-    vector->data = (int *) malloc(vector->size * sizeof(int));
-    logger(
-        INFO, debug, __func__,
-        "%li spaces in memory allocated for vector: %p.",
-        vector->size, vector
-    );
+int int_vector_min(const IntVector *vector)
+{
+    return simd_min(vector->data, vector->offset);
 }
 
-void int_vector_resize(IntVector *vector, size_t new_size)
+int int_vector_max(const IntVector *vector)
 {
-    if (new_size == -1) {
-        new_size = vector->size + DEFAULT_RESIZE_VALUE;
-    } else {
-        new_size += vector->size;
-    }
-    
-    size_t old_size = vector->size;
+    return simd_max(vector->data, vector->offset);
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Resizing vector: %p, old size: %li, new size: %li...",
-        vector, vector->size, new_size
-    );
+size_t int_vector_count(const IntVector *vector, int value)
+{
+    return simd_count(vector->data, vector->offset, value);
+}
 
-    logger(INFO, debug, __func__, "Saving vector contents to avoid data loss...");
-    int temp[old_size];
-    for (size_t i = 0; i < old_size; ++i) {
-        temp[i] = vector->data[i];
-    }
+size_t int_vector_find(const IntVector *vector, int value)
+{
+    return simd_find(vector->data, vector->offset, value);
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Vector contents saved. Freeing vector: %p, and re-initializing it with new size.",
-        vector
-    );
+size_t int_vector_remove(IntVector *vector, int value)
+{
+    size_t size = simd_remove(vector->data, vector->offset, value);
+    size_t removed = vector->offset - size;
+    vector->offset = size;
+    return removed;
+}
 
-    int_vector_free(vector);
-    int_vector_init(vector, new_size);
+static bool string_vector_is_arena(const StringVector *vector)
+{
+    return vector->offsets != NULL;
+}
 
-    logger(INFO, debug, __func__, "Restoring vector contents...");
-    for (size_t i = 0; i < old_size; ++i) {
-        vector->data[i] = temp[i];
-        ++vector->offset;
-    }
-    logger(INFO, debug, __func__, "Vector contents restored. Setting value 0 to the rest of the vector...");
-    int_vector_memset(vector, 0, old_size);
+static bool string_vector_is_initialized(const StringVector *vector)
+{
+    return vector->items || string_vector_is_arena(vector);
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Vector: %p resized. New size: %li",
-        vector, vector->size
-    );
+static bool string_vector_item_is_inline(const StringVectorItem *item)
+{
+    return item->allocated_size <= STRING_VECTOR_INLINE_SIZE;
 }
 
-void int_vector_init(IntVector *vector, size_t initial_size)
+static char *string_vector_item_data(StringVectorItem *item)
 {
-    if (initial_size == -1)
-        initial_size = DEFAULT_RESIZE_VALUE;
-    logger(INFO, debug, __func__, "Initializing vector: %p with size: %li", vector, initial_size);
+    return string_vector_item_is_inline(item) ? item->value.inline_data : item->value.heap;
+}
 
-    vector->size = initial_size;
-    vector->offset = 0;
+static void string_vector_item_init(StringVectorItem *item)
+{
+    item->allocated_size = STRING_VECTOR_INLINE_SIZE;
+    item->value.inline_data[0] = '\0';
+}
 
-    int_vector_allocate(vector);
-    int_vector_memset(vector, 0, 0);
+static void string_vector_item_free(const StringVector *vector, StringVectorItem *item)
+{
+    if (!string_vector_item_is_inline(item))
+        vector_free(vector->allocator, vector->stats, item->value.heap, item->allocated_size);
+    string_vector_item_init(item);
 }
 
-void int_vector_shrink(IntVector *vector)
+/* Makes sure item can hold a string of size characters. Strings that fit in STRING_VECTOR_INLINE_SIZE
+ * are kept inside the item itself, only longer ones get a block of memory of their own.
+ * Contents are NOT kept, this is meant to be called right before overwriting the item. */
+static bool string_vector_item_reserve(const StringVector *vector, StringVectorItem *item, size_t size)
 {
-    logger(
-        INFO, debug, __func__,
-        "Shrinking vector: %p, memory allocated: %li, actual size: %li",
-        vector, vector->size, vector->offset
+    if (size + 1 <= item->allocated_size)
+        return true;
+
+    LOG_INFO(
+        "Resizing vector item: %p, old size: %li, new size: %li...",
+        item, item->allocated_size, size + 1
     );
 
-    size_t new_size = vector->offset;
-    int temp[new_size];
+    char *heap = (char *) vector_alloc(vector->allocator, vector->stats, size * sizeof(char) + 1);
+    if (!heap) {
+        LOG_ERROR(
+            "There was an error while allocating vector item: %p with size: %li.",
+            item, size + 1
+        );
+        return false;
+    }
+
+    string_vector_item_free(vector, item);
+    item->value.heap = heap;
+    item->allocated_size = size * sizeof(char) + 1;
+    return true;
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Saving vector contents to avoid data loss..."
+// Reallocates the items of vector to new_size, items past offset are freed or initialized empty.
+static bool string_vector_items_reallocate(StringVector *vector, size_t new_size)
+{
+    for (size_t i = new_size; i < vector->vector_size; ++i)
+        string_vector_item_free(vector, &vector->items[i]);
+
+    // realloc() with a size of 0 may free the memory, so always keep room for one item.
+    size_t alloc_size = new_size ? new_size : 1;
+    size_t old_size = vector->vector_size ? vector->vector_size : 1;
+    StringVectorItem *items = (StringVectorItem *) vector_realloc(
+        vector->allocator, vector->stats, vector->items, old_size * sizeof(StringVectorItem), alloc_size * sizeof(StringVectorItem)
     );
+    if (items)
+        vector->items = items;
+    size_t *actual_sizes = items
+        ? (size_t *) vector_realloc(
+            vector->allocator, vector->stats, vector->actual_sizes, old_size * sizeof(size_t), alloc_size * sizeof(size_t)
+        )
+        : NULL;
+
+    if (!items || !actual_sizes) {
+        LOG_ERROR(
+            "There was an error while reallocating vector: %p to size: %li.",
+            vector, new_size
+        );
+        return false;
+    }
 
-    for (size_t i = 0; i < new_size; ++i) {
-        temp[i] = vector->data[i];
+    vector->actual_sizes = actual_sizes;
+    for (size_t i = vector->vector_size; i < new_size; ++i) {
+        string_vector_item_init(&vector->items[i]);
+        vector->actual_sizes[i] = 0;
     }
+    vector->vector_size = new_size;
+    return true;
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Vector contents saved in temporal array: %p.", temp
+static void string_vector_allocate(StringVector *vector, size_t vector_size, size_t items_size)
+{
+    LOG_INFO(
+        "Allocating memory to be able to hold %li strings with size: %li in vector: %p...",
+        vector_size, items_size, vector
     );
 
-    logger(
-        INFO, debug, __func__,
-        "Freeing vector: %p and re-initializing it with the actual size...",
-        vector
-    );
+    if (!string_vector_items_reallocate(vector, vector_size))
+        return;
 
-    int_vector_free(vector);
-    int_vector_init(vector, new_size);
-    logger(
-        INFO, debug, __func__,
-        "Vector: %p re-initialized. Restoring contents...",
-        vector
+    LOG_INFO(
+        "%li spaces in memory allocated for vector: %p.",
+        vector->vector_size, vector
     );
 
-    for (size_t i = 0; i < new_size; ++i) {
-        vector->data[i] = temp[i];
+    if (items_size + 1 > STRING_VECTOR_INLINE_SIZE) {
+        LOG_INFO("Initializing vector items...");
+        for (size_t i = 0; i < vector->vector_size; ++i) {
+            if (!string_vector_item_reserve(vector, &vector->items[i], items_size))
+                return;
+            string_vector_item_data(&vector->items[i])[0] = '\0';
+        }
+        LOG_INFO("All vector items were initialized.");
+    }
+}
+
+// Copies arena and offsets of a vector whose memory isn't its own to memory of its own.
+static bool string_vector_unshare(StringVector *vector)
+{
+    size_t used = vector->offsets[vector->offset];
+    char *arena = (char *) vector_alloc(vector->allocator, vector->stats, used ? used : 1);
+    size_t *offsets = (size_t *) vector_alloc(vector->allocator, vector->stats, (vector->vector_size + 1) * sizeof(size_t));
+    if (!arena || !offsets) {
+        LOG_ERROR("There was an error while copying vector: %p to memory of its own.", vector);
+        if (arena)
+            vector_free(vector->allocator, vector->stats, arena, used ? used : 1);
+        if (offsets)
+            vector_free(vector->allocator, vector->stats, offsets, (vector->vector_size + 1) * sizeof(size_t));
+        return false;
     }
 
-    logger(
-        INFO, debug, __func__,
-        "Contents restored on vector: %p. All done!",
-        vector
-    );
+    LOG_INFO("Copying vector: %p to memory of its own...", vector);
+    memcpy(arena, vector->arena, used);
+    memcpy(offsets, vector->offsets, (vector->offset + 1) * sizeof(size_t));
+    VECTOR_STATS_ADD(vector->stats, bytes_copied, used + (vector->offset + 1) * sizeof(size_t));
+    vector->release(vector->release_context);
+    vector->release = NULL;
+    vector->release_context = NULL;
+    vector->arena = arena;
+    vector->arena_size = used ? used : 1;
+    vector->offsets = offsets;
+    return true;
 }
 
-void int_vector_add(IntVector *vector, int value)
+// offsets holds one more entry than vector_size: the end of the last string.
+static bool string_vector_offsets_reallocate(StringVector *vector, size_t new_size)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, true, __func__,
-            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
-            vector
-        );
-        return;
-    }
+    if (vector->release && !string_vector_unshare(vector))
+        return false;
 
-    logger(
-        INFO, debug, __func__,
-        "Adding value: %i to vector: %p...",
-        value, vector
+    size_t *offsets = (size_t *) vector_realloc(
+        vector->allocator, vector->stats, vector->offsets,
+        vector->offsets ? (vector->vector_size + 1) * sizeof(size_t) : 0, (new_size + 1) * sizeof(size_t)
     );
-
-    if (vector->offset == vector->size) {
-        logger(
-            INFO, debug, __func__,
-            "Adding new value to vector causes it to be resized."
+    if (!offsets) {
+        LOG_ERROR(
+            "There was an error while reallocating offsets of vector: %p to size: %li.",
+            vector, new_size
         );
-        int_vector_resize(vector, -1);
+        return false;
     }
 
-    vector->data[vector->offset++] = value;
+    vector->offsets = offsets;
+    vector->vector_size = new_size;
+    return true;
 }
 
-void int_vector_add_array(IntVector *vector, const int array[], size_t array_size)
+static bool string_vector_arena_reallocate(StringVector *vector, size_t new_size)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, true, __func__,
-            "Vector: %p hasn't been properly initialized. Please call int_vector_init() before using this function.",
-            vector
-        );
-        return;
-    }
+    if (new_size == 0)
+        new_size = 1;
 
-    if (array_size > vector->size || (vector->offset + array_size) > vector->size) {
-        logger(
-            INFO, debug, __func__,
-            "Adding new values to vector causes it to be resized."
+    if (vector->release && !string_vector_unshare(vector))
+        return false;
+
+    char *arena = (char *) vector_realloc(vector->allocator, vector->stats, vector->arena, vector->arena_size, new_size);
+    if (!arena) {
+        LOG_ERROR(
+            "There was an error while reallocating arena of vector: %p to size: %li.",
+            vector, new_size
         );
-        int_vector_resize(vector, array_size);
+        return false;
     }
 
-    for (size_t i = 0; i < array_size; ++i) {
-        vector->data[vector->offset++] = array[i];
-    }
+    vector->arena = arena;
+    vector->arena_size = new_size;
+    return true;
 }
 
-void int_vector_copy(const IntVector *source, IntVector *dest)
+// Makes sure arena has room for at least n more bytes, growing it geometrically if it doesn't.
+static bool string_vector_arena_reserve(StringVector *vector, size_t n)
 {
-    logger(
-        INFO, debug, __func__,
-        "Copying vector contents from vector: %p to vector: %p...",
-        source, dest
-    );
+    size_t used = vector->offsets[vector->offset];
+    if (used + n <= vector->arena_size)
+        return true;
 
-    if (dest->size < source->offset) {
-        logger(INFO, debug, __func__, "Destination vector isn't big enough, resizing...");
-        int_vector_resize(dest, source->offset - dest->size);
-    }
+    size_t new_size = vector->arena_size * GROWTH_FACTOR;
+    if (new_size < used + n)
+        new_size = used + n;
 
-    for (size_t i = 0; i < source->offset; ++i) {
-        dest->data[dest->offset++] = source->data[i];
-    }
+    LOG_INFO(
+        "Growing arena of vector: %p, old size: %li, new size: %li...",
+        vector, vector->arena_size, new_size
+    );
 
-    logger(INFO, debug, __func__, "Vector copied.");
+    return string_vector_arena_reallocate(vector, new_size);
 }
 
-void int_vector_free(IntVector *vector)
+// Moves arena and offsets to memory from allocator. Returns false, leaving vector as it was, if there is no memory.
+static bool string_vector_arena_set_allocator(StringVector *vector, const VectorAllocator *allocator)
 {
-    logger(INFO, debug, __func__, "Freeing vector: %p.", vector);
-    free(vector->data);
-    vector->data = NULL;
-    vector->size = 0;
-    vector->offset = 0;
-    logger(INFO, debug, __func__, "Vector: %p freed.", vector);
+    size_t offsets_size = (vector->vector_size + 1) * sizeof(size_t);
+    char *arena = (char *) vector_alloc(allocator, vector->stats, vector->arena_size);
+    size_t *offsets = (size_t *) vector_alloc(allocator, vector->stats, offsets_size);
+    if (!arena || !offsets) {
+        if (arena)
+            vector_free(allocator, vector->stats, arena, vector->arena_size);
+        if (offsets)
+            vector_free(allocator, vector->stats, offsets, offsets_size);
+        return false;
+    }
+
+    memcpy(arena, vector->arena, vector->offsets[vector->offset]);
+    memcpy(offsets, vector->offsets, (vector->offset + 1) * sizeof(size_t));
+    VECTOR_STATS_ADD(vector->stats, bytes_copied, vector->offsets[vector->offset] + (vector->offset + 1) * sizeof(size_t));
+    vector_free(vector->allocator, vector->stats, vector->arena, vector->arena_size);
+    vector_free(vector->allocator, vector->stats, vector->offsets, offsets_size);
+    vector->arena = arena;
+    vector->offsets = offsets;
+    return true;
 }
 
-void int_vector_print(const IntVector *vector)
+// Moves items, sizes and every heap string to memory from allocator, with the same guarantee.
+static bool string_vector_items_set_allocator(StringVector *vector, const VectorAllocator *allocator)
 {
-    for (size_t i = 0; i < vector->size; ++i) {
-        printf("%i%s", vector->data[i], (i == vector->size - 1 ? "\n" : ", "));
+    size_t size = vector->vector_size ? vector->vector_size : 1;
+    StringVectorItem *items = (StringVectorItem *) vector_alloc(allocator, vector->stats, size * sizeof(StringVectorItem));
+    size_t *actual_sizes = (size_t *) vector_alloc(allocator, vector->stats, size * sizeof(size_t));
+    size_t moved = 0;
+
+    if (items && actual_sizes) {
+        memcpy(items, vector->items, vector->vector_size * sizeof(StringVectorItem));
+        for (; moved < vector->vector_size; ++moved) {
+            StringVectorItem *item = &items[moved];
+            if (string_vector_item_is_inline(item))
+                continue;
+
+            char *heap = (char *) vector_alloc(allocator, vector->stats, item->allocated_size);
+            if (!heap)
+                break;
+            memcpy(heap, item->value.heap, item->allocated_size);
+            VECTOR_STATS_ADD(vector->stats, bytes_copied, item->allocated_size);
+            item->value.heap = heap;
+        }
+    }
+
+    // Gives back everything taken from allocator so far when anything failed.
+    if (!items || !actual_sizes || moved < vector->vector_size) {
+        for (size_t i = 0; items && actual_sizes && i < moved; ++i) {
+            if (!string_vector_item_is_inline(&items[i]))
+                vector_free(allocator, vector->stats, items[i].value.heap, items[i].allocated_size);
+        }
+        if (items)
+            vector_free(allocator, vector->stats, items, size * sizeof(StringVectorItem));
+        if (actual_sizes)
+            vector_free(allocator, vector->stats, actual_sizes, size * sizeof(size_t));
+        return false;
     }
+
+    memcpy(actual_sizes, vector->actual_sizes, vector->vector_size * sizeof(size_t));
+    VECTOR_STATS_ADD(vector->stats, bytes_copied, vector->vector_size * (sizeof(StringVectorItem) + sizeof(size_t)));
+    for (size_t i = 0; i < vector->vector_size; ++i) {
+        if (!string_vector_item_is_inline(&vector->items[i]))
+            vector_free(vector->allocator, vector->stats, vector->items[i].value.heap, vector->items[i].allocated_size);
+    }
+    vector_free(vector->allocator, vector->stats, vector->items, size * sizeof(StringVectorItem));
+    vector_free(vector->allocator, vector->stats, vector->actual_sizes, size * sizeof(size_t));
+    vector->items = items;
+    vector->actual_sizes = actual_sizes;
+    return true;
 }
 
-int int_vector_get_at(const IntVector *vector, size_t index)
+/* Moves all memory of vector to memory from allocator, NULL meaning malloc().
+ * allocator must outlive the vector, or at least its memory. */
+bool string_vector_set_allocator(StringVector *vector, const VectorAllocator *allocator)
 {
-    if (index >= vector->size || index < 0) {
-        logger(
-            ERROR, true, __func__,
-            "Index: %li is out of bound.", index
+    if (!string_vector_is_initialized(vector)) {
+        LOG_ERROR(
+            "Vector: %p is NOT properly initialized. Please call string_vector_init() before using this function.",
+            vector
         );
-        return -1;
+        return false;
+    }
+
+    LOG_INFO("Moving vector: %p to allocator: %p...", vector, allocator);
+
+    if (vector->release) {
+        vector->allocator = allocator;
+        return string_vector_unshare(vector);
+    }
+
+    bool moved = string_vector_is_arena(vector)
+        ? string_vector_arena_set_allocator(vector, allocator)
+        : string_vector_items_set_allocator(vector, allocator);
+
+    if (!moved) {
+        LOG_ERROR("There was an error while moving vector: %p to allocator: %p.", vector, allocator);
+        return false;
     }
 
-    return vector->data[index];
+    vector->allocator = allocator;
+    return true;
 }
 
-int int_vector_get_last(const IntVector *vector)
+void string_vector_move(StringVector *source, StringVector *dest)
 {
-    return int_vector_get_at(vector, vector->offset - 1);
+    LOG_INFO("Moving vector: %p to vector: %p...", source, dest);
+    if (source == dest)
+        return;
+
+    string_vector_free(dest);
+    *dest = *source;
+    source->vector_size = 0;
+    source->offset = 0;
+    source->actual_sizes = NULL;
+    source->items = NULL;
+    source->arena = NULL;
+    source->arena_size = 0;
+    source->offsets = NULL;
+    source->index = NULL;
+    source->release = NULL;
+    source->release_context = NULL;
 }
 
-static void string_vector_allocate(StringVector *vector, size_t items_size)
+bool string_vector_adopt_arena(
+    StringVector *vector,
+    char *arena,
+    size_t arena_size,
+    size_t *offsets,
+    size_t count,
+    void (*release)(void *context),
+    void *context
+)
 {
-    logger(
-        INFO, debug, __func__,
-        "Allocating memory to be able to hold %li strings with size: %li in vector: %p...",
-        vector->vector_size, items_size, vector
-    );
-
-    vector->data = (char **) malloc(vector->vector_size * sizeof(char *));
-    vector->allocated_sizes = (size_t *) malloc(vector->vector_size * sizeof(size_t));
-    vector->actual_sizes = (size_t *) malloc(vector->vector_size * sizeof(size_t));
+    if (!arena || !offsets || arena_size == 0 || offsets[0] != 0 || offsets[count] > arena_size) {
+        LOG_ERROR("Can't adopt arena: %p of %li bytes holding %li strings.", arena, arena_size, count);
+        return false;
+    }
 
-    logger(
-        INFO, debug, __func__,
-        "%li spaces in memory allocated for vector: %p.",
-        vector->vector_size, vector
-    );
+    // Sizes and pointers handed out later rely on every string ending with its '\0', right before the next one.
+    for (size_t i = 0; i < count; ++i) {
+        if (offsets[i + 1] <= offsets[i] || arena[offsets[i + 1] - 1] != '\0') {
+            LOG_ERROR("String: %li of arena: %p isn't terminated by a '\\0' before the next one starts.", i, arena);
+            return false;
+        }
+    }
 
-    if (items_size > 0) {
-        logger(INFO, debug, __func__, "Initializing vector items...");
-        for (size_t i = 0; i < vector->vector_size; ++i) {
-            vector->allocated_sizes[i] = items_size * sizeof(char) + 1;
-            vector->data[i] = (char *) malloc(vector->allocated_sizes[i]);
-
-            if (!vector->data[i]) {
-                logger(
-                    ERROR, true, __func__,
-                    "There was an error while initializing vector item: %p with size: %li.",
-                    vector, vector->allocated_sizes[i]
-                );
-                return;
-            }
+    LOG_INFO("Vector: %p adopting arena: %p with %li strings.", vector, arena, count);
+    vector->vector_size = count;
+    vector->offset = count;
+    vector->actual_sizes = NULL;
+    vector->items = NULL;
+    vector->arena = arena;
+    vector->arena_size = arena_size;
+    vector->offsets = offsets;
+    vector->index = NULL;
+    vector->release = release;
+    vector->release_context = context;
+    vector->allocator = NULL;
+    vector->stats = NULL;
+
+    // Counted as allocated so the bytes freed along with the vector keep the counters balanced.
+    if (!release) {
+        VECTOR_STATS_ADD(NULL, allocations, 2);
+        VECTOR_STATS_ADD(NULL, bytes_allocated, arena_size + (count + 1) * sizeof(size_t));
+    }
+    return true;
+}
 
-            logger(
-                INFO, debug, __func__,
-                "Vector item: %p initialized.",
-                vector->data[i]
-            );
-        }
-        logger(INFO, debug, __func__, "All vector items were initialized.");
+char *string_vector_release_arena(StringVector *vector, size_t **offsets, size_t *count)
+{
+    if (!string_vector_is_arena(vector)) {
+        LOG_ERROR("Only arena vectors can release their memory, vector: %p isn't one.", vector);
+        return NULL;
     }
+
+    if ((vector->release || vector->allocator) && !string_vector_set_allocator(vector, NULL))
+        return NULL;
+
+    LOG_INFO("Releasing arena: %p of vector: %p.", vector->arena, vector);
+    char *arena = vector->arena;
+    *offsets = vector->offsets;
+    if (count)
+        *count = vector->offset;
+    VECTOR_STATS_ADD(vector->stats, frees, 2);
+    VECTOR_STATS_ADD(vector->stats, bytes_freed, vector->arena_size + (vector->vector_size + 1) * sizeof(size_t));
+
+    string_index_free(vector->index);
+    vector->index = NULL;
+    vector->arena = NULL;
+    vector->arena_size = 0;
+    vector->offsets = NULL;
+    vector->vector_size = 0;
+    vector->offset = 0;
+    return arena;
 }
 
-size_t string_vector_strlen(const char *value)
+void string_vector_set_stats(StringVector *vector, VectorStats *stats)
 {
-    size_t size = 0;
-    while (value[size] != '\0')
-        ++size;
-    return size;
+    vector->stats = stats;
 }
 
-static void string_vector_memset(StringVector *vector, char value, size_t start)
+void string_vector_stats(const StringVector *vector, VectorStats *stats)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, debug, __func__,
-            "Vector: %p is NOT properly initialized! Please call string_vector_init() before using this function.",
-            vector
-        );
+    if (vector->stats)
+        *stats = *vector->stats;
+    else
+        memset(stats, 0, sizeof(*stats));
+
+    // Unused slots of the tables, plus unused arena bytes or what heap strings hold past their characters.
+    size_t slots = vector->vector_size - vector->offset;
+    if (string_vector_is_arena(vector)) {
+        stats->slack = slots * sizeof(size_t) + vector->arena_size - vector->offsets[vector->offset];
         return;
     }
 
-    logger(
-        INFO, debug, __func__,
-        "Setting value: %c to vector: %p starting from: %li...",
-        value, vector, start
-    );
-
-    for (size_t i = start; i < vector->vector_size; ++i) {
-        size_t j;
-        for (j = 0; j < vector->allocated_sizes[i]; ++j) {
-            vector->data[i][j] = value;
-        }
-        vector->data[i][j] = '\0';
+    stats->slack = slots * (sizeof(StringVectorItem) + sizeof(size_t));
+    for (size_t i = 0; i < vector->offset; ++i) {
+        if (!string_vector_item_is_inline(&vector->items[i]))
+            stats->slack += vector->items[i].allocated_size - vector->actual_sizes[i] - 1;
     }
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Memory set."
-    );
+size_t string_vector_strlen(const char *value)
+{
+    return simd_strlen(value);
 }
 
 void string_vector_free(StringVector *vector)
 {
-    logger(INFO, debug, __func__, "Starting to free items in vector: %p...", vector);
-    for (size_t i = 0; i < vector->vector_size; ++i) {
-        logger(INFO, debug, __func__, "Freeing item: %p in vector: %p...", vector->data[i], vector);
-        free(vector->data[i]);
-
-        logger(INFO, debug, __func__, "Item: %p in vector: %p freed.", vector->data[i], vector);
-        vector->data[i] = NULL;
+    string_index_free(vector->index);
+    vector->index = NULL;
+
+    if (string_vector_is_arena(vector)) {
+        LOG_INFO("Freeing arena: %p of vector: %p...", vector->arena, vector);
+        if (vector->release) {
+            vector->release(vector->release_context);
+        } else {
+            vector_free(vector->allocator, vector->stats, vector->arena, vector->arena_size);
+            vector_free(vector->allocator, vector->stats, vector->offsets, (vector->vector_size + 1) * sizeof(size_t));
+        }
+        LOG_INFO("Vector: %p freed.", vector);
+
+        vector->arena = NULL;
+        vector->offsets = NULL;
+        vector->release = NULL;
+        vector->release_context = NULL;
+        vector->arena_size = 0;
+        vector->vector_size = 0;
+        vector->offset = 0;
+        return;
     }
 
-    logger(INFO, debug, __func__, "All items in vector: %p were freed. Freeing vector...", vector);
-    free(vector->data);
-    free(vector->allocated_sizes);
-    free(vector->actual_sizes);
-    logger(INFO, debug, __func__, "Vector: %p freed.", vector);
+    LOG_INFO("Starting to free items in vector: %p...", vector);
+    for (size_t i = 0; i < vector->vector_size; ++i)
+        string_vector_item_free(vector, &vector->items[i]);
 
-    vector->data = NULL;
-    vector->allocated_sizes = NULL;
+    LOG_INFO("All items in vector: %p were freed. Freeing vector...", vector);
+    size_t size = vector->vector_size ? vector->vector_size : 1;
+    vector_free(vector->allocator, vector->stats, vector->items, size * sizeof(StringVectorItem));
+    vector_free(vector->allocator, vector->stats, vector->actual_sizes, size * sizeof(size_t));
+    LOG_INFO("Vector: %p freed.", vector);
+
+    vector->items = NULL;
     vector->actual_sizes = NULL;
     vector->vector_size = 0;
     vector->offset = 0;
@@ -369,372 +553,375 @@ void string_vector_free(StringVector *vector)
 
 void string_vector_shrink(StringVector *vector)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, true, __func__,
+    if (!string_vector_is_initialized(vector)) {
+        LOG_ERROR(
             "Vector: %p is NOT properly initialized. Please call string_vector_init() and string_vector_add() before using this function.",
             vector
         );
         return;
     }
 
-    logger(
-        INFO, debug, __func__,
-        "Starting to shrink vector: %p. Saving vector contents to avoid data loss...",
-        vector
-    );
-
-    size_t actual_vector_size = vector->offset;
-    char *temp[actual_vector_size];
-    size_t sizes[actual_vector_size];
-
-    for (size_t i = 0; i < actual_vector_size; ++i) {
-        sizes[i] = vector->actual_sizes[i];
-        temp[i] = (char *) malloc(sizes[i] * sizeof(char) + 1);
-        for (size_t j = 0; j < sizes[i]; ++j) {
-            temp[i][j] = ' ';
-        }
-    }
-
-    for (size_t i = 0; i < vector->offset; ++i) {
-        logger(INFO, debug, __func__, "Saving vector item: %s...", vector->data[i]);
-        string_vector_strcpy(vector, vector->data[i], temp[i], sizes[i]);
+    if (string_vector_is_arena(vector)) {
+        LOG_INFO(
+            "Shrinking vector: %p, offsets to: %li, arena to: %li bytes...",
+            vector, vector->offset, vector->offsets[vector->offset]
+        );
+        string_vector_offsets_reallocate(vector, vector->offset);
+        string_vector_arena_reallocate(vector, vector->offsets[vector->offset]);
+        return;
     }
 
-    logger(
-        INFO, debug, __func__,
-        "Vector contents saved. Shrinking vector..."
-    );
-
-    string_vector_free(vector);
-    string_vector_init(vector, actual_vector_size, -1);
-
-    logger(
-        INFO, debug, __func__,
-        "Vector: %p shrinked. Restoring contents...",
-        vector
+    LOG_INFO(
+        "Shrinking vector: %p, memory allocated: %li, actual size: %li",
+        vector, vector->vector_size, vector->offset
     );
 
-    for (size_t i = 0; i < actual_vector_size; ++i) {
-        vector->actual_sizes[i] = sizes[i];
-        string_vector_strcpy(vector, temp[i], vector->data[i], vector->actual_sizes[i]);
-        ++vector->offset;
-        free(temp[i]);
+    if (string_vector_items_reallocate(vector, vector->offset)) {
+        LOG_INFO(
+            "Vector: %p shrinked. All done!",
+            vector
+        );
     }
-
-    logger(
-        INFO, debug, __func__,
-        "Vector contents restored. All done!"
-    );
 }
 
 void string_vector_shrink_items(StringVector *vector)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, true, __func__,
+    if (!string_vector_is_initialized(vector)) {
+        LOG_ERROR(
             "Vector: %p is NOT properly initialized. Please call string_vector_init() and string_vector_add() before using this function.",
             vector
         );
         return;
     }
 
-    logger(
-        INFO, debug, __func__,
-        "Starting to shrink vector items. Saving item contents to avoid data loss..."
-    );
+    // Arena items take exactly their size already, only the arena's spare room can be given back.
+    if (string_vector_is_arena(vector)) {
+        string_vector_arena_reallocate(vector, vector->offsets[vector->offset]);
+        return;
+    }
 
-    for (size_t i = 0; i < vector->offset; ++i) {
-        size_t item_size = string_vector_strlen(vector->data[i]);
-        char temp[item_size];
+    LOG_INFO("Starting to shrink vector items...");
 
-        // Set an empty character to the whole string for string_vector_strlen(), which is called by string_vector_strcpy(), to work correctly.
-        for (size_t j = 0; j < item_size; ++j) {
-            temp[j] = ' ';
-        }
+    for (size_t i = 0; i < vector->offset; ++i) {
+        StringVectorItem *item = &vector->items[i];
+        size_t item_size = vector->actual_sizes[i];
 
-        string_vector_strcpy(vector, vector->data[i], temp, item_size);
+        if (string_vector_item_is_inline(item) || item->allocated_size == item_size + 1)
+            continue;
 
-        logger(INFO, debug, __func__, "Item contents saved. Freeing item and re-initializing it with its actual size...");
-        free(vector->data[i]);
-        logger(INFO, debug, __func__, "Item: %p freed. Allocating string actual size...", vector->data[i]);
+        if (item_size + 1 <= STRING_VECTOR_INLINE_SIZE) {
+            LOG_INFO("Moving item: %p back inline...", item);
+            char *heap = item->value.heap;
+            memcpy(item->value.inline_data, heap, item_size + 1);
+            vector_free(vector->allocator, vector->stats, heap, item->allocated_size);
+            item->allocated_size = STRING_VECTOR_INLINE_SIZE;
+            continue;
+        }
 
-        vector->data[i] = NULL;
-        vector->data[i] = (char *) malloc(item_size * sizeof(char));
-        logger(
-            INFO, debug, __func__,
-            "Allocated %li bytes to vector item: %p. Setting default value to the whole string...",
-            item_size, vector->data[i]
+        char *heap = (char *) vector_realloc(
+            vector->allocator, vector->stats, item->value.heap, item->allocated_size, item_size * sizeof(char) + 1
         );
-
-        for (size_t j = 0; j < item_size; ++j) {
-            vector->data[i][j] = ' ';
+        if (!heap) {
+            LOG_ERROR("There was an error while shrinking vector item: %p.", item);
+            continue;
         }
 
-        logger(INFO, debug, __func__, "Item shrinked. Restoring contents...");
-        string_vector_strcpy(vector, temp, vector->data[i], item_size);
+        item->value.heap = heap;
+        item->allocated_size = item_size * sizeof(char) + 1;
+        LOG_INFO(
+            "Allocated %li bytes to vector item: %p.",
+            item->allocated_size, item
+        );
     }
 
-    logger(
-        INFO, debug, __func__,
+    LOG_INFO(
         "Vector items shrinked!"
     );
 }
 
-size_t string_vector_get_vector_item_pos(const StringVector *vector, char **item)
+/* Copies n characters of src into dest and terminates it. dest must have room for n + 1 characters,
+ * items are resized by string_vector_add() before copying. */
+void string_vector_strcpy(const char *src, char *dest, const size_t n)
 {
-    size_t pos = -1;
-    for (size_t i = 0; i < vector->vector_size; ++i) {
-        if (vector->data[i] == *item) {
-            pos = i;
-            break;
-        }
-    }
-    return pos;
+    LOG_INFO(
+        "Copying %li individual characters of string: %s held by pointer: %p into pointer: %p...",
+        n, src, src, dest
+    );
+
+    memcpy(dest, src, n);
+    dest[n] = '\0';
+
+    LOG_INFO(
+        "Vector item contents copied."
+    );
 }
 
-/* vector is just for this function to know which item _item_ points to inside vector,
- * so we can make vector->item_size[item] as long as its new size. */
-static void string_vector_item_resize(const StringVector *vector, char **item, size_t new_size, bool save_contents)
+void string_vector_resize(StringVector *vector, size_t new_size)
 {
-    size_t old_size = string_vector_strlen(*item);
+    size_t old_size = vector->vector_size;
     if (new_size == -1) {
-        new_size = old_size + DEFAULT_STRING_SIZE;
+        new_size = old_size * GROWTH_FACTOR;
+        if (new_size < old_size + DEFAULT_RESIZE_VALUE)
+            new_size = old_size + DEFAULT_RESIZE_VALUE;
     } else {
         new_size += old_size;
     }
 
-    logger(
-        INFO, debug, __func__,
-        "Resizing vector item: %p, old size: %li, new size: %li...",
-        item, old_size, new_size
+    LOG_INFO(
+        "Resizing vector: %p, old size: %li, new size: %li...",
+        vector, old_size, new_size
     );
 
-    char *temp;
-    if (save_contents) {
-        logger(
-            INFO, debug, __func__,
-            "Saving item contents to avoid data loss..."
-        );
-
-        temp = (char *) malloc(old_size * sizeof(char));
-        string_vector_strcpy(vector, *item, temp, old_size);
-
-        logger(INFO, debug, __func__, "Item contents saved. Freing item: %p and re-initializing it with new size...", item);
-    } else {
-        logger(INFO, debug, __func__, "Freeing item: %p and re-initializing it with new size...", item);
-    }
-
-    size_t pos = string_vector_get_vector_item_pos(vector, item);
-    vector->allocated_sizes[pos] = new_size * sizeof(char) + 1; 
-
-    free(*item);
-    *item = (char *) malloc(vector->allocated_sizes[pos]);
-
-    if (save_contents) {
-        logger(INFO, debug, __func__, "Restoring contents...");
-        for (size_t i = 0; i < old_size; ++i) {
-            *item[i] = temp[i];
-        }
-        free(temp);
+    // In arena mode only the offsets table has one entry per item, strings are not touched.
+    if (string_vector_is_arena(vector)) {
+        string_vector_offsets_reallocate(vector, new_size);
+        return;
     }
 
-    logger(INFO, debug, __func__, "Setting default value for the rest of the item...");
-    size_t start = save_contents ? old_size : 0;
-    for (size_t i = start; i < new_size; ++i) {
-        (*item)[i] = ' ';
+    // Heap items are moved as they are, only the item records themselves get reallocated.
+    if (string_vector_items_reallocate(vector, new_size)) {
+        LOG_INFO(
+            "Vector: %p resized.",
+            vector
+        );
     }
-
-    logger(INFO, debug, __func__, "Vector item: %p resized.", item);
 }
 
-/* vector is needed because this function may use string_vector_resize(). */
-void string_vector_strcpy(
-    const StringVector *vector,
-    const char *src,
-    char *dest,
-    const size_t n)
+void string_vector_init(StringVector *vector, size_t vector_size, size_t items_size)
 {
-    logger(
-        INFO, debug, __func__,
-        "Copying %li individual characters of string: %s held by pointer: %p into pointer: %p...",
-        n, src, src, dest
-    );
-
-    size_t src_size = string_vector_strlen(src);
-    size_t dest_size = string_vector_strlen(dest);
-    logger(INFO, debug, __func__, "Source size is: %li, destination size is: %li.", src_size, dest_size);
-
-    if (src_size > dest_size) {
-        logger(INFO, debug, __func__, "Destination pointer isn't as big as source. Resizing...");
-        string_vector_item_resize(vector, &dest, n, false);
-        logger(INFO, debug, __func__, "Destination pointer resized. Continuing...");
+    if (vector_size == -1) {
+        vector_size = DEFAULT_RESIZE_VALUE;
     }
 
-    size_t i;
-    for (i = 0; i < n; ++i) {
-        dest[i] = src[i];
-    }
-    dest[i] = '\0';
+    // By default items start inline and only get memory of their own when a long string is added.
+    if (items_size == -1)
+        items_size = 0;
 
-    logger(
-        INFO, debug, __func__,
-        "Vector item contents copied."
+    LOG_INFO(
+        "Initializing vector: %p with initial vector size: %li, initial vector items size: %li...",
+           vector, vector_size, items_size
     );
+
+    vector->vector_size = 0;
+    vector->offset = 0;
+    vector->actual_sizes = NULL;
+    vector->items = NULL;
+    vector->arena = NULL;
+    vector->arena_size = 0;
+    vector->offsets = NULL;
+    vector->index = NULL;
+    vector->release = NULL;
+    vector->release_context = NULL;
+    vector->allocator = NULL;
+    vector->stats = NULL;
+    string_vector_allocate(vector, vector_size, items_size);
 }
 
-void string_vector_resize(StringVector *vector, size_t new_size)
+void string_vector_init_arena(StringVector *vector, size_t vector_size, size_t arena_size)
 {
-    size_t old_size = vector->vector_size;
-    if (new_size == -1) {
-        new_size = old_size + DEFAULT_RESIZE_VALUE;
-    } else {
-        new_size += old_size;
-    }
+    if (vector_size == -1)
+        vector_size = DEFAULT_RESIZE_VALUE;
 
-    logger(
-        INFO, debug, __func__,
-        "Resizing vector: %p, old size: %li, new size: %li...",
-        vector, old_size, new_size
-    );
+    if (arena_size == -1)
+        arena_size = DEFAULT_ARENA_SIZE;
 
-    logger(
-        INFO, debug, __func__,
-        "Saving vector contents to avoid data loss..."
+    LOG_INFO(
+        "Initializing vector: %p with initial vector size: %li, initial arena size: %li...",
+        vector, vector_size, arena_size
     );
 
-    char *temp[old_size];
-    size_t sizes[old_size];
+    vector->vector_size = 0;
+    vector->offset = 0;
+    vector->actual_sizes = NULL;
+    vector->items = NULL;
+    vector->arena = NULL;
+    vector->arena_size = 0;
+    vector->offsets = NULL;
+    vector->index = NULL;
+    vector->release = NULL;
+    vector->release_context = NULL;
+    vector->allocator = NULL;
+    vector->stats = NULL;
+
+    if (!string_vector_offsets_reallocate(vector, vector_size))
+        return;
+    vector->offsets[0] = 0;
 
-    for (size_t i = 0; i < old_size; ++i) {
-        sizes[i] = vector->actual_sizes[i];
-        temp[i] = (char *) malloc(sizes[i] * sizeof(char) + 1);
-        // This assignment here is for string_vector_strlen() which string_vector_strcpy() calls to work.
-        for (size_t j = 0; j < sizes[i]; ++j) {
-            temp[i][j] = ' ';
-        }
-        string_vector_strcpy(vector, vector->data[i], temp[i], sizes[i]);
+    if (!string_vector_arena_reallocate(vector, arena_size)) {
+        vector_free(vector->allocator, vector->stats, vector->offsets, (vector->vector_size + 1) * sizeof(size_t));
+        vector->offsets = NULL;
+        vector->vector_size = 0;
     }
+}
 
-    logger(
-        INFO, debug, __func__,
-        "Vector contents saved. Freeing vector: %p, and re-initializing it with new size...",
-        vector
-    );
-
-    string_vector_free(vector);
-    string_vector_init(vector, new_size, -1);
+// Returns the size the table of a vector holding size strings should grow to, to fit needed ones.
+static size_t string_vector_grown_size(size_t size, size_t needed)
+{
+    size_t new_size = size * GROWTH_FACTOR;
+    if (new_size < size + DEFAULT_RESIZE_VALUE)
+        new_size = size + DEFAULT_RESIZE_VALUE;
+    return new_size < needed ? needed : new_size;
+}
 
-    for (size_t i = 0; i < new_size; ++i) {
-        vector->allocated_sizes[i] = sizes[i];
-        vector->data[i] = (char *) malloc(vector->allocated_sizes[i] * sizeof(char) + 1);
+// Appending to an arena is a bump of its used size plus a single copy.
+static bool string_vector_arena_add(StringVector *vector, const char *value, size_t value_size)
+{
+    if (vector->offset == vector->vector_size) {
+        LOG_INFO("Adding new value causes offsets to be resized.");
+        if (!string_vector_offsets_reallocate(vector, string_vector_grown_size(vector->vector_size, 0)))
+            return false;
     }
 
-    logger(INFO, debug, __func__, "Restoring contents...");
-    for (size_t i = 0; i < old_size; ++i) {
-        vector->actual_sizes[i] = sizes[i];
-        string_vector_strcpy(vector, temp[i], vector->data[i], vector->actual_sizes[i]);
-        ++vector->offset;
-    }
+    if (!string_vector_arena_reserve(vector, value_size + 1))
+        return false;
 
-    logger(
-        INFO, debug, __func__,
-        "Vector contents restored."
-    );
+    size_t start = vector->offsets[vector->offset];
+    memcpy(vector->arena + start, value, value_size + 1);
+    vector->offsets[++vector->offset] = start + value_size + 1;
+    return true;
 }
 
-void string_vector_init(StringVector *vector, size_t vector_size, size_t items_size)
+static bool string_vector_items_add(StringVector *vector, const char *value, size_t value_size)
 {
-    if (vector_size == -1) {
-        vector_size = DEFAULT_RESIZE_VALUE;
+    if (vector->offset == vector->vector_size) {
+        LOG_INFO(
+            "Adding new value causes resizing."
+        );
+        string_vector_resize(vector, -1);
+        if (vector->offset == vector->vector_size)
+            return false;
     }
 
-    if (items_size == -1)
-        items_size = DEFAULT_STRING_SIZE;
+    StringVectorItem *item = &vector->items[vector->offset];
+    if (!string_vector_item_reserve(vector, item, value_size))
+        return false;
 
-    logger(
-        INFO, debug, __func__,
-        "Initializing vector: %p with initial vector size: %li, initial vector items size: %li...",
-           vector, vector_size, items_size
-    );
+    vector->actual_sizes[vector->offset] = value_size;
+    string_vector_strcpy(value, string_vector_item_data(item), value_size);
+    ++vector->offset;
+    return true;
+}
 
-    vector->vector_size = vector_size;
-    vector->offset = 0;
-    string_vector_allocate(vector, items_size);
-    string_vector_memset(vector, ' ', 0);
+/* Adds a string to the index of vector. An index missing a string would make string_vector_find() miss it too,
+ * so if the index can't grow it's dropped, and lookups go back to scanning the vector. */
+static bool string_vector_index_add(StringVector *vector, const char *value, size_t value_size, size_t position)
+{
+    if (string_index_add(vector->index, vector, value, value_size, position))
+        return true;
+
+    LOG_ERROR("There was an error while growing the index of vector: %p, dropping it.", vector);
+    string_index_free(vector->index);
+    vector->index = NULL;
+    return false;
 }
 
 void string_vector_add(StringVector *vector, const char *value)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, true, __func__,
+    if (!string_vector_is_initialized(vector)) {
+        LOG_ERROR(
             "Vector: %p is NOT properly initialized! Please call string_vector_init() before using this function.",
             vector
         );
         return;
     }
 
-    logger(
-        INFO, debug, __func__,
+    LOG_INFO(
         "Adding value: %s to vector: %p...",
         value, vector
     );
 
-    if (vector->offset == vector->vector_size) {
-        logger(
-            INFO, debug, __func__,
-            "Adding new value causes resizing."
-        );
-        string_vector_resize(vector, -1);
-    }
-
     size_t value_size = string_vector_strlen(value);
+    VECTOR_STATS_ADD(vector->stats, strlen_calls, 1);
+    bool added = string_vector_is_arena(vector)
+        ? string_vector_arena_add(vector, value, value_size)
+        : string_vector_items_add(vector, value, value_size);
 
-    vector->actual_sizes[vector->offset] = value_size;
-    string_vector_strcpy(vector, value, vector->data[vector->offset], value_size);
-    ++vector->offset;
+    if (!added)
+        return;
 
-    logger(
-        INFO, debug, __func__,
+    if (vector->index)
+        string_vector_index_add(vector, value, value_size, vector->offset - 1);
+
+    LOG_INFO(
         "Value: %s added to vector: %p.",
         value, vector
     );
 }
 
-static bool string_vector_is_empty(const char *value)
+/* Adds count strings at once: the offsets or items table and the arena are grown a single time,
+ * and every string is measured once. */
+void string_vector_add_array(StringVector *vector, const char *values[], size_t count)
 {
-    size_t value_size = string_vector_strlen(value);
-    for (size_t i = 0; i < value_size; ++i) {
-        if (value[i] != ' ')
-            return false;
+    if (!string_vector_is_initialized(vector)) {
+        LOG_ERROR(
+            "Vector: %p is NOT properly initialized! Please call string_vector_init() before using this function.",
+            vector
+        );
+        return;
     }
-    return true;
+
+    LOG_INFO("Adding %li values to vector: %p...", count, vector);
+
+    size_t *sizes = (size_t *) malloc(count * sizeof(size_t));
+    if (!sizes && count > 0) {
+        LOG_ERROR("There was an error while allocating memory to add %li values to vector: %p.", count, vector);
+        return;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sizes[i] = string_vector_strlen(values[i]);
+        total += sizes[i] + 1;
+    }
+    VECTOR_STATS_ADD(vector->stats, strlen_calls, count);
+
+    size_t first = vector->offset;
+    bool reserved = vector->offset + count <= vector->vector_size;
+    if (!reserved) {
+        size_t new_size = string_vector_grown_size(vector->vector_size, vector->offset + count);
+        reserved = string_vector_is_arena(vector)
+            ? string_vector_offsets_reallocate(vector, new_size)
+            : string_vector_items_reallocate(vector, new_size);
+    }
+    if (reserved && string_vector_is_arena(vector))
+        reserved = string_vector_arena_reserve(vector, total);
+
+    for (size_t i = 0; reserved && i < count; ++i) {
+        if (string_vector_is_arena(vector)) {
+            size_t start = vector->offsets[vector->offset];
+            memcpy(vector->arena + start, values[i], sizes[i] + 1);
+            vector->offsets[++vector->offset] = start + sizes[i] + 1;
+        } else if (!string_vector_items_add(vector, values[i], sizes[i])) {
+            break;
+        }
+    }
+
+    for (size_t i = first; vector->index && i < vector->offset; ++i)
+        string_vector_index_add(vector, values[i - first], sizes[i - first], i);
+
+    free(sizes);
+    LOG_INFO("%li values added to vector: %p.", vector->offset - first, vector);
 }
 
 void string_vector_print(StringVector *vector)
 {
-    if (!vector->data) {
-        logger(
-            ERROR, true, __func__,
+    if (!string_vector_is_initialized(vector)) {
+        LOG_ERROR(
             "Vector: %p is NOT properly initialized. Please call string_vector_init() and string_vector_add() before using this function.",
             vector
         );
         return;
     }
 
-    for (size_t i = 0; i < vector->vector_size; ++i) {
-        if (string_vector_is_empty(vector->data[i]))
-            continue;
-        printf("%s\n", vector->data[i]);
-    }
+    for (size_t i = 0; i < vector->offset; ++i)
+        printf("%s\n", string_vector_get_at(vector, i));
 }
 
 // Returns true if index is valid, otherwise write a log telling the user index is not valid.
 static bool check_index(const StringVector *vector, const size_t index)
 {
-    if (index < 0 || index >= vector->vector_size) {
-        logger(ERROR, true, __func__, "Index: %li is out of bound.", index);
+    if (index >= vector->offset) {
+        LOG_ERROR("Index: %li is out of bound.", index);
         return false;
     }
     return true;
@@ -742,12 +929,121 @@ static bool check_index(const StringVector *vector, const size_t index)
 
 char *string_vector_get_at(const StringVector *vector, const size_t index)
 {
-    if (check_index(vector, index))
-        return vector->data[index];
-    return NULL;
+    if (!check_index(vector, index))
+        return NULL;
+    if (string_vector_is_arena(vector))
+        return vector->arena + vector->offsets[index];
+    return string_vector_item_data(&vector->items[index]);
 }
 
 char *string_vector_get_last(const StringVector *vector)
 {
     return string_vector_get_at(vector, vector->offset - 1);
 }
+
+size_t string_vector_get_size(const StringVector *vector, const size_t index)
+{
+    if (!check_index(vector, index))
+        return -1;
+    if (string_vector_is_arena(vector))
+        return vector->offsets[index + 1] - vector->offsets[index] - 1;
+    return vector->actual_sizes[index];
+}
+
+void string_vector_enable_index(StringVector *vector)
+{
+    if (vector->index)
+        return;
+
+    LOG_INFO("Building index for vector: %p with %li items...", vector, vector->offset);
+
+    vector->index = string_index_new(vector->offset);
+    if (!vector->index)
+        return;
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        if (!string_vector_index_add(vector, string_vector_get_at(vector, i), string_vector_get_size(vector, i), i))
+            return;
+    }
+
+    LOG_INFO("Index for vector: %p built.", vector);
+}
+
+size_t string_vector_find(const StringVector *vector, const char *value)
+{
+    size_t value_size = string_vector_strlen(value);
+    VECTOR_STATS_ADD(vector->stats, strlen_calls, 1);
+    if (vector->index)
+        return string_index_find(vector->index, vector, value, value_size);
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        if (string_vector_get_size(vector, i) == value_size
+                && memcmp(string_vector_get_at(vector, i), value, value_size) == 0)
+            return i;
+    }
+    return -1;
+}
+
+bool string_vector_equals(const StringVector *vector, size_t index, const char *value)
+{
+    size_t size = string_vector_get_size(vector, index);
+    if (size == (size_t) -1)
+        return false;
+
+    size_t value_size = string_vector_strlen(value);
+    VECTOR_STATS_ADD(vector->stats, strlen_calls, 1);
+    return value_size == size && memcmp(string_vector_get_at(vector, index), value, size) == 0;
+}
+
+bool string_vector_starts_with(const StringVector *vector, size_t index, const char *prefix)
+{
+    size_t size = string_vector_get_size(vector, index);
+    if (size == (size_t) -1)
+        return false;
+
+    size_t prefix_size = string_vector_strlen(prefix);
+    VECTOR_STATS_ADD(vector->stats, strlen_calls, 1);
+    return prefix_size <= size && memcmp(string_vector_get_at(vector, index), prefix, prefix_size) == 0;
+}
+
+// Returns the index of the arena string holding byte position, offsets[index] <= position < offsets[index + 1].
+static size_t string_vector_arena_index(const StringVector *vector, size_t first, size_t position)
+{
+    size_t low = first;
+    size_t high = vector->offset;
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (vector->offsets[middle] <= position)
+            low = middle;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+size_t string_vector_find_substring(const StringVector *vector, size_t from, const char *needle)
+{
+    size_t needle_size = string_vector_strlen(needle);
+    VECTOR_STATS_ADD(vector->stats, strlen_calls, 1);
+    if (from >= vector->offset)
+        return -1;
+
+    /* Arena strings are searched in a single pass over the arena: needle holds no '\0', so it can't match across
+     * the end of a string, and a match is mapped back to its string with a binary search of offsets. */
+    if (string_vector_is_arena(vector)) {
+        size_t start = vector->offsets[from];
+        size_t position = simd_search(
+            vector->arena + start, vector->offsets[vector->offset] - start, needle, needle_size
+        );
+        return position == (size_t) -1 ? position : string_vector_arena_index(vector, from, start + position);
+    }
+
+    // Strings shorter than needle are skipped by their length alone.
+    for (size_t i = from; i < vector->offset; ++i) {
+        size_t size = vector->actual_sizes[i];
+        const char *value = string_vector_item_data(&vector->items[i]);
+        if (size >= needle_size && simd_search(value, size, needle, needle_size) != (size_t) -1)
+            return i;
+    }
+    return -1;
+}
@@ -1,48 +1,232 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include "vector_template.h"
+
 #include <stdbool.h>
 #include <stdio.h>
 
-#define DEFAULT_RESIZE_VALUE 10
-#define DEFAULT_STRING_SIZE 63
+#define DEFAULT_ARENA_SIZE 1024
+#define STRING_VECTOR_INLINE_SIZE 16
+// Vectors up to this size are sorted with insertion sort instead of radix sort.
+#define SORT_INSERTION_THRESHOLD 64
+// Vectors smaller than this are sorted by a single thread, even by int_vector_parallel_sort().
+#define SORT_PARALLEL_THRESHOLD (1 << 16)
+
+VECTOR_DECLARE(IntVector, int_vector, int)
 
+/* Strings shorter than STRING_VECTOR_INLINE_SIZE are stored inside the item itself,
+ * longer ones get a block of memory of their own. */
 typedef struct {
-    int *data;
-    size_t size;
-    size_t offset;
-} IntVector;
+    size_t allocated_size;
+    union {
+        char *heap;
+        char inline_data[STRING_VECTOR_INLINE_SIZE];
+    } value;
+} StringVectorItem;
+
+// Pool of threads run by the parallel algorithms, see thread_pool.h.
+typedef struct ThreadPool ThreadPool;
+
+// Hash index of a StringVector, see string_vector_enable_index().
+typedef struct StringVectorIndex StringVectorIndex;
 
 typedef struct {
     size_t vector_size;
     size_t offset;
-    size_t *allocated_sizes;
     size_t *actual_sizes;
-    char **data;
+    StringVectorItem *items;
+    /* Arena storage, see string_vector_init_arena(). All strings live back to back in arena,
+     * string i starts at offsets[i] and offsets[offset] is the amount of arena bytes in use. */
+    char *arena;
+    size_t arena_size;
+    size_t *offsets;
+    StringVectorIndex *index;
+    /* Set when arena and offsets aren't memory of the vector's own, e.g. a mapped file. It's called instead of free()
+     * to give them back, and growing the vector copies them to memory of its own first. */
+    void (*release)(void *context);
+    void *release_context;
+    // Where all memory of the vector comes from, NULL means malloc(). See allocator.h.
+    const VectorAllocator *allocator;
+    // Counters of this vector, NULL for the global ones only. See vector_stats.h.
+    VectorStats *stats;
 } StringVector;
 
+// Streams strings into a snapshot file without a StringVector holding them, see string_vector_writer_open().
+typedef struct {
+    int fd;
+    char *path;
+    char *buffer;
+    size_t buffered;
+    size_t blob_size;
+    // Where every string written so far starts, plus the end of the last one.
+    size_t *offsets;
+    size_t count;
+    size_t offsets_size;
+    // Set once a write fails, string_vector_writer_close() then removes the file instead.
+    bool failed;
+} StringVectorWriter;
+
+/* Read-only window over numbers owned by someone else, an IntVector or any array. Number i is data[i * stride].
+ * Views are passed by value and slicing them copies nothing, so they must not outlive the numbers, nor be used
+ * after the vector they come from grows. */
+typedef struct {
+    const int *data;
+    size_t size;
+    size_t stride;
+} IntVectorView;
+
+/* Read-only window over the strings of a StringVector, or over an array of strings when vector is NULL.
+ * String i of the view is string begin + i * stride of the source. */
+typedef struct {
+    const StringVector *vector;
+    const char *const *strings;
+    size_t begin;
+    size_t size;
+    size_t stride;
+} StringVectorView;
+
 void set_debug(bool value);
-void int_vector_resize(IntVector *vector, size_t new_size);
-void int_vector_shrink(IntVector *vector);
-void int_vector_init(IntVector *vector, size_t initial_size);
-void int_vector_add(IntVector *vector, int value);
-void int_vector_add_array(IntVector *vector, const int array[], size_t array_size);
-void int_vector_copy(const IntVector *source, IntVector *dest);
-void int_vector_free(IntVector *vector);
 void int_vector_print(const IntVector *vector);
 int int_vector_get_at(const IntVector *vector, const size_t index);
 int int_vector_get_last(const IntVector *vector);
+/* Reductions and searches over the items of vector, using the SIMD kernels in simd.h.
+ * min and max of an empty vector are INT_MAX and INT_MIN, find returns -1 if value isn't there. */
+long long int_vector_sum(const IntVector *vector);
+int int_vector_min(const IntVector *vector);
+int int_vector_max(const IntVector *vector);
+size_t int_vector_count(const IntVector *vector, int value);
+size_t int_vector_find(const IntVector *vector, int value);
+/* Removes every number equal to value keeping the order of the rest, in a single pass which packs
+ * whole registers of kept numbers at a time. Returns how many numbers were removed. */
+size_t int_vector_remove(IntVector *vector, int value);
+/* Sorts vector in ascending order with a radix sort, using its spare capacity as scratch memory when big enough.
+ * int_vector_parallel_sort() splits every pass between threads threads. */
+void int_vector_sort(IntVector *vector);
+void int_vector_parallel_sort(IntVector *vector, size_t threads);
+/* The following functions expect vectors sorted in ascending order, e.g. by int_vector_sort().
+ * Set operations replace the contents of dest, which must be an initialized vector other than a and b. */
+size_t int_vector_lower_bound(const IntVector *vector, int value);
+size_t int_vector_upper_bound(const IntVector *vector, int value);
+bool int_vector_contains(const IntVector *vector, int value);
+void int_vector_intersect(const IntVector *a, const IntVector *b, IntVector *dest);
+void int_vector_union(const IntVector *a, const IntVector *b, IntVector *dest);
+void int_vector_difference(const IntVector *a, const IntVector *b, IntVector *dest);
+/* Parallel algorithms, splitting the work between the threads of pool, or of a pool shared by all of them
+ * with one thread per CPU when pool is NULL. Results of map and fill replace the contents of the destination. */
+void int_vector_parallel_for_each(IntVector *vector, void (*fn)(int *value, void *context), void *context, ThreadPool *pool);
+void int_vector_parallel_map(
+    const IntVector *source,
+    IntVector *dest,
+    int (*fn)(int value, void *context),
+    void *context,
+    ThreadPool *pool
+);
+int int_vector_parallel_reduce(
+    const IntVector *vector,
+    int identity,
+    int (*combine)(int a, int b, void *context),
+    void *context,
+    ThreadPool *pool
+);
+void int_vector_parallel_fill(IntVector *vector, int value, size_t size, ThreadPool *pool);
+/* Binary snapshots. int_vector_open_mmap() initializes vector with data pointing into a private mapping of the file,
+ * so opening is O(1) no matter how many numbers it holds. Growing the vector copies them to memory of its own. */
+bool int_vector_save(const IntVector *vector, const char *path);
+bool int_vector_open_mmap(IntVector *vector, const char *path);
+bool int_vector_verify_file(const char *path);
+/* Text export and import a big buffer at a time instead of a call per number. write_text separates numbers with
+ * separator and ends with a newline, read_text appends every number in fd and skips anything between them. */
+bool int_vector_write_text(const IntVector *vector, int fd, const char *separator);
+bool int_vector_read_text(IntVector *vector, int fd);
+/* Views. slice takes numbers [begin, end) of view and stride every step-th number, an empty view is returned
+ * and an error logged when out of bound. Contiguous views use the same SIMD kernels as vectors, the sorted
+ * searches expect the numbers of the view in ascending order. */
+IntVectorView int_vector_view(const IntVector *vector);
+IntVectorView int_vector_view_of(const int *data, size_t size);
+IntVectorView int_vector_view_slice(IntVectorView view, size_t begin, size_t end);
+IntVectorView int_vector_view_stride(IntVectorView view, size_t step);
+int int_vector_view_get_at(IntVectorView view, size_t index);
+long long int_vector_view_sum(IntVectorView view);
+int int_vector_view_min(IntVectorView view);
+int int_vector_view_max(IntVectorView view);
+size_t int_vector_view_count(IntVectorView view, int value);
+size_t int_vector_view_find(IntVectorView view, int value);
+size_t int_vector_view_lower_bound(IntVectorView view, int value);
+size_t int_vector_view_upper_bound(IntVectorView view, int value);
+bool int_vector_view_contains(IntVectorView view, int value);
+// Appends the numbers of view, which must not point into vector, with a single memcpy() when it is contiguous.
+bool int_vector_add_view(IntVector *vector, IntVectorView view);
 
 size_t string_vector_strlen(const char *value);
 void string_vector_init(StringVector *vector, size_t vector_size, size_t items_size);
-void string_vector_strcpy(const StringVector *vector, const char *src, char *dest, const size_t n);
+void string_vector_init_arena(StringVector *vector, size_t vector_size, size_t arena_size);
+// Copies n characters of src into dest, which must have room for them and the terminating '\0'.
+void string_vector_strcpy(const char *src, char *dest, const size_t n);
 void string_vector_resize(StringVector *vector, size_t new_size);
 void string_vector_free(StringVector *vector);
 void string_vector_shrink(StringVector *vector);
 void string_vector_shrink_items(StringVector *vector);
+bool string_vector_set_allocator(StringVector *vector, const VectorAllocator *allocator);
+/* Ownership transfer without copying, the same as int_vector_move(), int_vector_adopt() and int_vector_release().
+ * Adopting and releasing use the arena layout: count strings back to back in arena, string i starting at offsets[i]
+ * and ending with a '\0' right before offsets[i + 1], offsets holding count + 1 entries starting with 0.
+ * Adopting checks that layout, reading the offsets and the terminator of every string, and fails if it doesn't hold.
+ * Without release both come from malloc() and become the vector's own memory,
+ * otherwise release(context) is called to give them back. string_vector_release_arena() fails on slot vectors,
+ * the caller must free() the arena it returns and the offsets it puts in offsets. */
+void string_vector_move(StringVector *source, StringVector *dest);
+bool string_vector_adopt_arena(
+    StringVector *vector,
+    char *arena,
+    size_t arena_size,
+    size_t *offsets,
+    size_t count,
+    void (*release)(void *context),
+    void *context
+);
+char *string_vector_release_arena(StringVector *vector, size_t **offsets, size_t *count);
+// Same as int_vector_set_stats() and int_vector_stats(), slack includes unused arena and heap string bytes.
+void string_vector_set_stats(StringVector *vector, VectorStats *stats);
+void string_vector_stats(const StringVector *vector, VectorStats *stats);
 void string_vector_add(StringVector *vector, const char *value);
+void string_vector_add_array(StringVector *vector, const char *values[], size_t count);
 void string_vector_print(StringVector *vector);
 char *string_vector_get_at(const StringVector *vector, const size_t index);
 char *string_vector_get_last(const StringVector *vector);
+// Returns the length of the string at index, or -1 if index is out of bound.
+size_t string_vector_get_size(const StringVector *vector, const size_t index);
+/* Builds a hash index over the strings of vector, which string_vector_add() keeps up to date from then on.
+ * Strings changed in place through string_vector_get_at() aren't tracked. If the index runs out of memory it's dropped
+ * and string_vector_find() scans the vector again. */
+void string_vector_enable_index(StringVector *vector);
+/* Returns the index of the first string equal to value, or -1 if there is none.
+ * Expected O(1) with an index, a linear scan otherwise. */
+size_t string_vector_find(const StringVector *vector, const char *value);
+/* Comparisons using the stored length of the string at index rather than measuring it, false if index is out of bound.
+ * string_vector_find_substring() returns the index of the first string from index from on which contains needle,
+ * or -1 if there is none. The strings of an arena vector are searched as a whole in a single pass. */
+bool string_vector_equals(const StringVector *vector, size_t index, const char *value);
+bool string_vector_starts_with(const StringVector *vector, size_t index, const char *prefix);
+size_t string_vector_find_substring(const StringVector *vector, size_t from, const char *needle);
+/* Snapshot files hold the strings back to back followed by their offsets, the same layout as arena mode.
+ * string_vector_open_mmap() initializes an arena vector pointing into a private mapping of the file, so
+ * string_vector_get_at() returns pointers into it and strings are only read from disk when used.
+ * Adding to such a vector copies it to memory of its own first. */
+bool string_vector_save(const StringVector *vector, const char *path);
+bool string_vector_open_mmap(StringVector *vector, const char *path);
+/* Writes a snapshot file one string at a time. Only the offsets of the strings are kept in memory,
+ * the file appears at path once string_vector_writer_close() succeeds. */
+bool string_vector_writer_open(StringVectorWriter *writer, const char *path);
+bool string_vector_writer_add(StringVectorWriter *writer, const char *value);
+bool string_vector_writer_close(StringVectorWriter *writer);
+// Views of strings, working the same way as the ones of numbers.
+StringVectorView string_vector_view(const StringVector *vector);
+StringVectorView string_vector_view_of(const char *const strings[], size_t count);
+StringVectorView string_vector_view_slice(StringVectorView view, size_t begin, size_t end);
+StringVectorView string_vector_view_stride(StringVectorView view, size_t step);
+const char *string_vector_view_get_at(StringVectorView view, size_t index);
+size_t string_vector_view_get_size(StringVectorView view, size_t index);
+size_t string_vector_view_find(StringVectorView view, const char *value);
 
 #endif // VECTOR_H
@@ -0,0 +1,134 @@
+#include "vector_stats.h"
+#include "logger.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Thread_local VectorStatsBlock *vector_stats_local;
+
+// Blocks of the running threads, and the counters of the ones which exited added up.
+static VectorStatsBlock *blocks;
+static uint64_t retired[VECTOR_STATS_COUNTERS];
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t thread_exit_key;
+static pthread_once_t thread_exit_once = PTHREAD_ONCE_INIT;
+/* Block of a thread which couldn't allocate one. It needs no memory of its own and still belongs to that thread
+ * alone, it just can't be freed. Thread storage outlives retire_block(), which runs while the thread exits. */
+static _Thread_local VectorStatsBlock fallback_block;
+
+static void add_block(uint64_t counters[], VectorStatsBlock *block)
+{
+    for (size_t i = 0; i < VECTOR_STATS_COUNTERS; ++i) {
+        uint64_t value = atomic_load_explicit(&block->counters[i], memory_order_relaxed);
+        // The peak is the biggest of all threads, everything else adds up.
+        if (i != VECTOR_STATS_INDEX(peak_capacity))
+            counters[i] += value;
+        else if (value > counters[i])
+            counters[i] = value;
+    }
+}
+
+// Moves the counters of an exiting thread into retired and frees its block.
+static void retire_block(void *arg)
+{
+    VectorStatsBlock *block = (VectorStatsBlock *) arg;
+
+    pthread_mutex_lock(&blocks_lock);
+    for (VectorStatsBlock **link = &blocks; *link; link = &(*link)->next) {
+        if (*link == block) {
+            *link = block->next;
+            break;
+        }
+    }
+    add_block(retired, block);
+    pthread_mutex_unlock(&blocks_lock);
+
+    vector_stats_local = NULL;
+    if (block != &fallback_block)
+        free(block);
+}
+
+static void create_thread_exit_key(void)
+{
+    pthread_key_create(&thread_exit_key, retire_block);
+}
+
+VectorStatsBlock *vector_stats_register(void)
+{
+    pthread_once(&thread_exit_once, create_thread_exit_key);
+
+    VectorStatsBlock *block = (VectorStatsBlock *) calloc(1, sizeof(VectorStatsBlock));
+    if (!block) {
+        LOG_ERROR("There was an error while allocating statistics for thread, counting into a static block.");
+        block = &fallback_block;
+        // It may have been retired before, with its counts already added to retired.
+        for (size_t i = 0; i < VECTOR_STATS_COUNTERS; ++i)
+            atomic_store_explicit(&block->counters[i], 0, memory_order_relaxed);
+    }
+
+    pthread_mutex_lock(&blocks_lock);
+    block->next = blocks;
+    blocks = block;
+    pthread_mutex_unlock(&blocks_lock);
+
+    pthread_setspecific(thread_exit_key, block);
+    vector_stats_local = block;
+    return block;
+}
+
+VectorStats vector_stats_snapshot(void)
+{
+    uint64_t counters[VECTOR_STATS_COUNTERS];
+
+    pthread_mutex_lock(&blocks_lock);
+    for (size_t i = 0; i < VECTOR_STATS_COUNTERS; ++i)
+        counters[i] = retired[i];
+    for (VectorStatsBlock *block = blocks; block; block = block->next)
+        add_block(counters, block);
+    pthread_mutex_unlock(&blocks_lock);
+
+    VectorStats stats;
+    memcpy(&stats, counters, sizeof(stats));
+    return stats;
+}
+
+typedef struct {
+    size_t index;
+    const char *name;
+    const char *type;
+    const char *help;
+} VectorStatsMetric;
+
+static const VectorStatsMetric metrics[] = {
+    { VECTOR_STATS_INDEX(allocations), "allocations_total", "counter", "Blocks of memory allocated by vectors." },
+    { VECTOR_STATS_INDEX(reallocations), "reallocations_total", "counter", "Blocks of memory of vectors reallocated." },
+    { VECTOR_STATS_INDEX(frees), "frees_total", "counter", "Blocks of memory freed by vectors." },
+    { VECTOR_STATS_INDEX(bytes_allocated), "allocated_bytes_total", "counter", "Bytes allocated by vectors." },
+    { VECTOR_STATS_INDEX(bytes_freed), "freed_bytes_total", "counter", "Bytes freed by vectors." },
+    { VECTOR_STATS_INDEX(bytes_copied), "copied_bytes_total", "counter", "Bytes copied to new memory by vectors." },
+    { VECTOR_STATS_INDEX(peak_capacity), "peak_capacity_bytes", "gauge", "Biggest block of memory asked for by a vector." },
+    { VECTOR_STATS_INDEX(slack), "slack_bytes", "gauge", "Bytes allocated by vectors but not holding items." },
+    { VECTOR_STATS_INDEX(strlen_calls), "strlen_calls_total", "counter", "Strings measured by vectors." }
+};
+
+bool vector_stats_write_prometheus(FILE *file, const VectorStats *stats, const char *labels)
+{
+    const uint64_t *counters = (const uint64_t *) stats;
+    int written = 0;
+
+    for (size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]) && written >= 0; ++i) {
+        const VectorStatsMetric *metric = &metrics[i];
+        written = fprintf(
+            file, "# HELP vector_%s %s\n# TYPE vector_%s %s\nvector_%s%s%s%s %llu\n",
+            metric->name, metric->help, metric->name, metric->type, metric->name,
+            labels ? "{" : "", labels ? labels : "", labels ? "}" : "", (unsigned long long) counters[metric->index]
+        );
+    }
+
+    if (written < 0) {
+        LOG_ERROR("There was an error while writing statistics to file: %p.", (void *) file);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef VECTOR_STATS_H
+#define VECTOR_STATS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Counters of what vectors do with memory. Every vector adds to the global counters, see vector_stats_snapshot(),
+ * and vectors given a VectorStats of their own with int_vector_set_stats() or string_vector_set_stats() add to
+ * it as well. Reallocating counts as allocating the new size and freeing the old one, so bytes_allocated minus
+ * bytes_freed is the memory held at any time. Build with -DVECTOR_NO_STATS to remove counting altogether. */
+typedef struct {
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t frees;
+    uint64_t bytes_allocated;
+    uint64_t bytes_freed;
+    // Bytes moved to new memory by growing, shrinking or changing allocators.
+    uint64_t bytes_copied;
+    // Biggest single block of memory asked for, in bytes.
+    uint64_t peak_capacity;
+    // Bytes allocated but not holding items. Only known for a single vector, see int_vector_stats().
+    uint64_t slack;
+    uint64_t strlen_calls;
+} VectorStats;
+
+#define VECTOR_STATS_COUNTERS (sizeof(VectorStats) / sizeof(uint64_t))
+#define VECTOR_STATS_INDEX(field) (offsetof(VectorStats, field) / sizeof(uint64_t))
+
+// Global counters of one thread. Only that thread writes them, so relaxed loads and stores are enough.
+typedef struct VectorStatsBlock {
+    _Atomic uint64_t counters[VECTOR_STATS_COUNTERS];
+    struct VectorStatsBlock *next;
+} VectorStatsBlock;
+
+extern _Thread_local VectorStatsBlock *vector_stats_local;
+// Gives the calling thread its block of counters, the first time it counts anything.
+VectorStatsBlock *vector_stats_register(void);
+
+static inline _Atomic uint64_t *vector_stats_counter(size_t index)
+{
+    VectorStatsBlock *block = vector_stats_local ? vector_stats_local : vector_stats_register();
+    return &block->counters[index];
+}
+
+#ifdef VECTOR_NO_STATS
+#define VECTOR_STATS_ADD(stats, field, value) ((void) (stats))
+#define VECTOR_STATS_MAX(stats, field, value) ((void) (stats))
+#else
+/* Adds value to field of the global counters and of stats when it isn't NULL. */
+#define VECTOR_STATS_ADD(stats, field, value) \
+    do { \
+        VectorStats *stats_ = (stats); \
+        uint64_t value_ = (value); \
+        _Atomic uint64_t *counter_ = vector_stats_counter(VECTOR_STATS_INDEX(field)); \
+        atomic_store_explicit(counter_, atomic_load_explicit(counter_, memory_order_relaxed) + value_, memory_order_relaxed); \
+        if (stats_) \
+            stats_->field += value_; \
+    } while (0)
+/* Raises field of the global counters and of stats when it isn't NULL to value, if it's bigger. */
+#define VECTOR_STATS_MAX(stats, field, value) \
+    do { \
+        VectorStats *stats_ = (stats); \
+        uint64_t value_ = (value); \
+        _Atomic uint64_t *counter_ = vector_stats_counter(VECTOR_STATS_INDEX(field)); \
+        if (atomic_load_explicit(counter_, memory_order_relaxed) < value_) \
+            atomic_store_explicit(counter_, value_, memory_order_relaxed); \
+        if (stats_ && stats_->field < value_) \
+            stats_->field = value_; \
+    } while (0)
+#endif
+
+// Adds up the counters of every thread, including the ones which already exited.
+VectorStats vector_stats_snapshot(void);
+/* Writes stats in the Prometheus text format, one vector_<counter> metric each. labels are put between the braces
+ * of every sample as they are, e.g. "vector=\"users\"", or nothing when NULL. Returns false on a write error. */
+bool vector_stats_write_prometheus(FILE *file, const VectorStats *stats, const char *labels);
+
+#endif // VECTOR_STATS_H
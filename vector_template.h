@@ -0,0 +1,531 @@
+#ifndef VECTOR_TEMPLATE_H
+#define VECTOR_TEMPLATE_H
+
+#include "allocator.h"
+#include "logger.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_RESIZE_VALUE 10
+#define GROWTH_FACTOR 2
+
+/* Generates a vector of T items named name, whose functions are prefixed with prefix, e.g.:
+ *
+ *     VECTOR_DEFINE(DoubleVector, double_vector, double)
+ *
+ * gives DoubleVector along with double_vector_init(), double_vector_add(), double_vector_at()...
+ * following the same conventions as IntVector. VECTOR_DEFINE() makes every function static inline,
+ * so the compiler sees the actual item type. To share one copy of the functions between several files,
+ * put VECTOR_DECLARE() in a header and VECTOR_IMPLEMENT() with an empty linkage in one source file. */
+#define VECTOR_DEFINE(name, prefix, T) \
+    VECTOR_DECLARE_TYPE(name, T) \
+    VECTOR_IMPLEMENT(static inline, name, prefix, T)
+
+#define VECTOR_DECLARE_TYPE(name, T) \
+    typedef struct { \
+        T *data; \
+        size_t size; \
+        size_t offset; \
+        /* Set when data isn't memory of the vector's own, e.g. a mapped file. It's called instead of free() \
+         * to give data back, and growing the vector copies the items to memory of its own first. */ \
+        void (*release)(void *data, size_t size, void *context); \
+        void *release_context; \
+        /* Where data comes from, NULL means malloc(). See allocator.h. */ \
+        const VectorAllocator *allocator; \
+        /* Counters of this vector, NULL for the global ones only. See vector_stats.h. */ \
+        VectorStats *stats; \
+    } name;
+
+#define VECTOR_DECLARE(name, prefix, T) \
+    VECTOR_DECLARE_TYPE(name, T) \
+    void prefix##_init(name *vector, size_t initial_size); \
+    void prefix##_resize(name *vector, size_t new_size); \
+    void prefix##_reserve(name *vector, size_t size); \
+    void prefix##_shrink(name *vector); \
+    void prefix##_add(name *vector, T value); \
+    void prefix##_add_array(name *vector, const T array[], size_t array_size); \
+    T *prefix##_append_uninit(name *vector, size_t n); \
+    bool prefix##_extend(name *vector, const T array[], size_t array_size); \
+    bool prefix##_pop(name *vector, T *value); \
+    bool prefix##_insert_at(name *vector, size_t index, T value); \
+    bool prefix##_erase_at(name *vector, size_t index); \
+    bool prefix##_swap_remove(name *vector, size_t index); \
+    bool prefix##_erase_range(name *vector, size_t begin, size_t end); \
+    size_t prefix##_remove_if(name *vector, bool (*predicate)(const T *value, void *context), void *context); \
+    T *prefix##_at(const name *vector, size_t index); \
+    void prefix##_copy(const name *source, name *dest); \
+    bool prefix##_set_allocator(name *vector, const VectorAllocator *allocator); \
+    void prefix##_set_stats(name *vector, VectorStats *stats); \
+    void prefix##_stats(const name *vector, VectorStats *stats); \
+    void prefix##_move(name *source, name *dest); \
+    bool prefix##_adopt( \
+        name *vector, \
+        T *data, \
+        size_t size, \
+        size_t capacity, \
+        void (*release)(void *data, size_t size, void *context), \
+        void *context \
+    ); \
+    T *prefix##_release(name *vector, size_t *size); \
+    void prefix##_free(name *vector);
+
+#define VECTOR_IMPLEMENT(linkage, name, prefix, T) \
+/* Moves the items of a vector whose data isn't its own to new_size items of memory of its own. */ \
+static inline bool prefix##_unshare(name *vector, size_t new_size) \
+{ \
+    T *data = (T *) vector_alloc(vector->allocator, vector->stats, new_size * sizeof(T)); \
+    if (!data) { \
+        LOG_ERROR( \
+            "There was an error while copying vector: %p to size: %li.", \
+            (void *) vector, new_size \
+        ); \
+        return false; \
+    } \
+\
+    LOG_INFO("Copying vector: %p to memory of its own...", (void *) vector); \
+    size_t copied = (new_size < vector->size ? new_size : vector->size) * sizeof(T); \
+    memcpy(data, vector->data, copied); \
+    VECTOR_STATS_ADD(vector->stats, bytes_copied, copied); \
+    vector->release(vector->data, vector->size, vector->release_context); \
+    vector->release = NULL; \
+    vector->release_context = NULL; \
+    vector->data = data; \
+    vector->size = new_size; \
+    return true; \
+} \
+\
+/* Reallocates vector's memory in place to hold exactly new_size items. \
+ * Contents are kept by realloc(), the new tail is left uninitialized. */ \
+static inline bool prefix##_reallocate(name *vector, size_t new_size) \
+{ \
+    /* realloc() with a size of 0 may free the memory, so always keep room for one item. */ \
+    if (new_size == 0) \
+        new_size = 1; \
+\
+    if (vector->release) \
+        return prefix##_unshare(vector, new_size); \
+\
+    T *data = (T *) vector_realloc(vector->allocator, vector->stats, vector->data, vector->size * sizeof(T), new_size * sizeof(T)); \
+    if (!data) { \
+        LOG_ERROR( \
+            "There was an error while reallocating vector: %p to size: %li.", \
+            (void *) vector, new_size \
+        ); \
+        return false; \
+    } \
+\
+    vector->data = data; \
+    vector->size = new_size; \
+    return true; \
+} \
+\
+/* Grows vector geometrically so it can hold at least min_size items. \
+ * Multiplying the size instead of adding a constant keeps adding items amortized O(1). */ \
+static inline bool prefix##_grow(name *vector, size_t min_size) \
+{ \
+    size_t new_size = vector->size * GROWTH_FACTOR; \
+    if (new_size < vector->size + DEFAULT_RESIZE_VALUE) \
+        new_size = vector->size + DEFAULT_RESIZE_VALUE; \
+    if (new_size < min_size) \
+        new_size = min_size; \
+\
+    LOG_INFO( \
+        "Growing vector: %p, old size: %li, new size: %li...", \
+        (void *) vector, vector->size, new_size \
+    ); \
+\
+    return prefix##_reallocate(vector, new_size); \
+} \
+\
+linkage void prefix##_init(name *vector, size_t initial_size) \
+{ \
+    if (initial_size == (size_t) -1) \
+        initial_size = DEFAULT_RESIZE_VALUE; \
+    LOG_INFO("Initializing vector: %p with size: %li", (void *) vector, initial_size); \
+\
+    vector->data = NULL; \
+    vector->size = 0; \
+    vector->offset = 0; \
+    vector->release = NULL; \
+    vector->release_context = NULL; \
+    vector->allocator = NULL; \
+    vector->stats = NULL; \
+\
+    /* Items past offset are never read, so the memory is left as it is instead of being cleared. */ \
+    prefix##_reallocate(vector, initial_size); \
+} \
+\
+linkage void prefix##_resize(name *vector, size_t new_size) \
+{ \
+    if (new_size == (size_t) -1) { \
+        prefix##_grow(vector, vector->size + 1); \
+        return; \
+    } \
+\
+    new_size += vector->size; \
+\
+    LOG_INFO( \
+        "Resizing vector: %p, old size: %li, new size: %li...", \
+        (void *) vector, vector->size, new_size \
+    ); \
+\
+    if (prefix##_reallocate(vector, new_size)) { \
+        LOG_INFO( \
+            "Vector: %p resized. New size: %li", \
+            (void *) vector, vector->size \
+        ); \
+    } \
+} \
+\
+/* Makes sure vector can hold at least size items without being resized again. */ \
+linkage void prefix##_reserve(name *vector, size_t size) \
+{ \
+    if (size <= vector->size) \
+        return; \
+\
+    LOG_INFO( \
+        "Reserving room for %li items in vector: %p...", \
+        size, (void *) vector \
+    ); \
+\
+    prefix##_reallocate(vector, size); \
+} \
+\
+linkage void prefix##_shrink(name *vector) \
+{ \
+    LOG_INFO( \
+        "Shrinking vector: %p, memory allocated: %li, actual size: %li", \
+        (void *) vector, vector->size, vector->offset \
+    ); \
+\
+    if (prefix##_reallocate(vector, vector->offset)) { \
+        LOG_INFO( \
+            "Vector: %p shrinked. All done!", \
+            (void *) vector \
+        ); \
+    } \
+} \
+\
+linkage void prefix##_add(name *vector, T value) \
+{ \
+    if (!vector->data) { \
+        LOG_ERROR( \
+            "Vector: %p hasn't been properly initialized. Please call " #prefix "_init() before using this function.", \
+            (void *) vector \
+        ); \
+        return; \
+    } \
+\
+    LOG_INFO("Adding value to vector: %p...", (void *) vector); \
+\
+    if (vector->offset == vector->size) { \
+        LOG_INFO( \
+            "Adding new value to vector causes it to be resized." \
+        ); \
+        if (!prefix##_grow(vector, vector->size + 1)) \
+            return; \
+    } \
+\
+    vector->data[vector->offset++] = value; \
+} \
+\
+/* Makes room for n more items at the end of vector and returns a pointer to the first of them, \
+ * or NULL if there is no memory left. They count as items of vector right away, but are left \
+ * uninitialized: the caller writes them, e.g. decoding straight into the vector. */ \
+linkage T *prefix##_append_uninit(name *vector, size_t n) \
+{ \
+    if (!vector->data) { \
+        LOG_ERROR( \
+            "Vector: %p hasn't been properly initialized. Please call " #prefix "_init() before using this function.", \
+            (void *) vector \
+        ); \
+        return NULL; \
+    } \
+\
+    if (vector->offset + n > vector->size) { \
+        LOG_INFO( \
+            "Adding new values to vector causes it to be resized." \
+        ); \
+        if (!prefix##_grow(vector, vector->offset + n)) \
+            return NULL; \
+    } \
+\
+    T *items = vector->data + vector->offset; \
+    vector->offset += n; \
+    return items; \
+} \
+\
+/* Appends array_size items with a single growth and a single memcpy(). Returns false if there is no memory left. */ \
+linkage bool prefix##_extend(name *vector, const T array[], size_t array_size) \
+{ \
+    /* array may be part of vector itself, e.g. copying a vector into itself, and growing may move it. */ \
+    bool aliased = vector->data && array >= vector->data && array < vector->data + vector->size; \
+    size_t start = aliased ? (size_t) (array - vector->data) : 0; \
+\
+    T *items = prefix##_append_uninit(vector, array_size); \
+    if (!items) \
+        return false; \
+\
+    memmove(items, aliased ? vector->data + start : array, array_size * sizeof(T)); \
+    return true; \
+} \
+\
+linkage void prefix##_add_array(name *vector, const T array[], size_t array_size) \
+{ \
+    prefix##_extend(vector, array, array_size); \
+} \
+\
+/* Removes the last item of vector and stores it in value, unless value is NULL. \
+ * Returns false if vector is empty. */ \
+linkage bool prefix##_pop(name *vector, T *value) \
+{ \
+    if (vector->offset == 0) { \
+        LOG_ERROR("Vector: %p is empty.", (void *) vector); \
+        return false; \
+    } \
+\
+    --vector->offset; \
+    if (value) \
+        *value = vector->data[vector->offset]; \
+    return true; \
+} \
+\
+/* Inserts value before the item at index, moving the following ones one position up. \
+ * index may be the number of items, to add value at the end. Returns false on error. */ \
+linkage bool prefix##_insert_at(name *vector, size_t index, T value) \
+{ \
+    if (index > vector->offset) { \
+        LOG_ERROR("Index: %li is out of bound.", index); \
+        return false; \
+    } \
+\
+    if (!prefix##_append_uninit(vector, 1)) \
+        return false; \
+\
+    memmove(vector->data + index + 1, vector->data + index, (vector->offset - 1 - index) * sizeof(T)); \
+    vector->data[index] = value; \
+    return true; \
+} \
+\
+/* Removes the items in [begin, end), moving the following ones down. Returns false if the range is out of bound. */ \
+linkage bool prefix##_erase_range(name *vector, size_t begin, size_t end) \
+{ \
+    if (begin > end || end > vector->offset) { \
+        LOG_ERROR("Range: [%li, %li) is out of bound.", begin, end); \
+        return false; \
+    } \
+\
+    memmove(vector->data + begin, vector->data + end, (vector->offset - end) * sizeof(T)); \
+    vector->offset -= end - begin; \
+    return true; \
+} \
+\
+linkage bool prefix##_erase_at(name *vector, size_t index) \
+{ \
+    if (index >= vector->offset) { \
+        LOG_ERROR("Index: %li is out of bound.", index); \
+        return false; \
+    } \
+\
+    return prefix##_erase_range(vector, index, index + 1); \
+} \
+\
+/* Removes the item at index in O(1) by moving the last item in its place, so the order isn't kept. */ \
+linkage bool prefix##_swap_remove(name *vector, size_t index) \
+{ \
+    if (index >= vector->offset) { \
+        LOG_ERROR("Index: %li is out of bound.", index); \
+        return false; \
+    } \
+\
+    vector->data[index] = vector->data[--vector->offset]; \
+    return true; \
+} \
+\
+/* Removes every item predicate returns true for in a single pass, keeping the order of the rest. \
+ * Returns how many items were removed. */ \
+linkage size_t prefix##_remove_if(name *vector, bool (*predicate)(const T *value, void *context), void *context) \
+{ \
+    size_t kept = 0; \
+    for (size_t i = 0; i < vector->offset; ++i) { \
+        bool removed = predicate(&vector->data[i], context); \
+        if (!removed && kept != i) \
+            vector->data[kept] = vector->data[i]; \
+        kept += !removed; \
+    } \
+\
+    size_t removed = vector->offset - kept; \
+    vector->offset = kept; \
+    return removed; \
+} \
+\
+/* Returns a pointer to the item at index, or NULL if index is out of bound. */ \
+linkage T *prefix##_at(const name *vector, size_t index) \
+{ \
+    if (index >= vector->offset) { \
+        LOG_ERROR( \
+            "Index: %li is out of bound.", index \
+        ); \
+        return NULL; \
+    } \
+\
+    return &vector->data[index]; \
+} \
+\
+/* Appends the items of source to dest. */ \
+linkage void prefix##_copy(const name *source, name *dest) \
+{ \
+    LOG_INFO( \
+        "Copying vector contents from vector: %p to vector: %p...", \
+        (void *) source, (void *) dest \
+    ); \
+\
+    if (prefix##_extend(dest, source->data, source->offset)) \
+        LOG_INFO("Vector copied."); \
+} \
+\
+/* Moves the items of vector to memory from allocator, NULL meaning malloc(). \
+ * allocator must outlive the vector, or at least its memory. */ \
+linkage bool prefix##_set_allocator(name *vector, const VectorAllocator *allocator) \
+{ \
+    LOG_INFO("Moving vector: %p to allocator: %p...", (void *) vector, (void *) allocator); \
+\
+    if (vector->release) { \
+        vector->allocator = allocator; \
+        return prefix##_unshare(vector, vector->size ? vector->size : 1); \
+    } \
+\
+    size_t size = vector->size ? vector->size : 1; \
+    T *data = (T *) vector_alloc(allocator, vector->stats, size * sizeof(T)); \
+    if (!data) { \
+        LOG_ERROR( \
+            "There was an error while moving vector: %p to allocator: %p.", \
+            (void *) vector, (void *) allocator \
+        ); \
+        return false; \
+    } \
+\
+    if (vector->data) { \
+        memcpy(data, vector->data, vector->offset * sizeof(T)); \
+        VECTOR_STATS_ADD(vector->stats, bytes_copied, vector->offset * sizeof(T)); \
+        vector_free(vector->allocator, vector->stats, vector->data, vector->size * sizeof(T)); \
+    } \
+    vector->data = data; \
+    vector->size = size; \
+    vector->allocator = allocator; \
+    return true; \
+} \
+\
+/* Makes vector count into stats besides the global counters, NULL to stop. stats isn't cleared, \
+ * so several vectors can share one. */ \
+linkage void prefix##_set_stats(name *vector, VectorStats *stats) \
+{ \
+    vector->stats = stats; \
+} \
+\
+/* Fills stats with the counters of vector, all zero if it has none, and its slack. */ \
+linkage void prefix##_stats(const name *vector, VectorStats *stats) \
+{ \
+    if (vector->stats) \
+        *stats = *vector->stats; \
+    else \
+        memset(stats, 0, sizeof(*stats)); \
+    stats->slack = (vector->size - vector->offset) * sizeof(T); \
+} \
+\
+linkage void prefix##_free(name *vector) \
+{ \
+    LOG_INFO("Freeing vector: %p.", (void *) vector); \
+    if (vector->release) \
+        vector->release(vector->data, vector->size, vector->release_context); \
+    else \
+        vector_free(vector->allocator, vector->stats, vector->data, vector->size * sizeof(T)); \
+    vector->data = NULL; \
+    vector->release = NULL; \
+    vector->release_context = NULL; \
+    vector->size = 0; \
+    vector->offset = 0; \
+    LOG_INFO("Vector: %p freed.", (void *) vector); \
+} \
+\
+/* Hands the items of source over to dest in O(1), whatever was in dest is freed first. \
+ * dest must be initialized or freed, source is left freed. */ \
+linkage void prefix##_move(name *source, name *dest) \
+{ \
+    LOG_INFO("Moving vector: %p to vector: %p...", (void *) source, (void *) dest); \
+    if (source == dest) \
+        return; \
+\
+    prefix##_free(dest); \
+    *dest = *source; \
+    source->data = NULL; \
+    source->size = 0; \
+    source->offset = 0; \
+    source->release = NULL; \
+    source->release_context = NULL; \
+} \
+\
+/* Initializes vector with size items already in data, which has room for capacity items. \
+ * Without release, data must come from malloc() and becomes the vector's own memory. Otherwise data stays \
+ * the caller's: release(data, capacity, context) is called to give it back, and growing copies it first. */ \
+linkage bool prefix##_adopt( \
+    name *vector, \
+    T *data, \
+    size_t size, \
+    size_t capacity, \
+    void (*release)(void *data, size_t size, void *context), \
+    void *context \
+) \
+{ \
+    if (!data || capacity == 0 || size > capacity) { \
+        LOG_ERROR( \
+            "Can't adopt buffer: %p holding %li items with room for %li.", \
+            (void *) data, size, capacity \
+        ); \
+        return false; \
+    } \
+\
+    LOG_INFO("Vector: %p adopting buffer: %p with %li items.", (void *) vector, (void *) data, size); \
+    vector->data = data; \
+    vector->size = capacity; \
+    vector->offset = size; \
+    vector->release = release; \
+    vector->release_context = context; \
+    vector->allocator = NULL; \
+    vector->stats = NULL; \
+\
+    /* Counted as allocated so the bytes freed along with the vector keep the counters balanced. */ \
+    if (!release) { \
+        VECTOR_STATS_ADD(NULL, allocations, 1); \
+        VECTOR_STATS_ADD(NULL, bytes_allocated, capacity * sizeof(T)); \
+    } \
+    return true; \
+} \
+\
+/* Takes the items away from vector in O(1) and returns them, and their amount in size if not NULL. \
+ * The caller must free() them. Items from an allocator or a buffer of someone else's are copied to \
+ * memory from malloc() first. vector is left freed, NULL is returned if it holds no memory. */ \
+linkage T *prefix##_release(name *vector, size_t *size) \
+{ \
+    if (!vector->data) \
+        return NULL; \
+\
+    if ((vector->release || vector->allocator) && !prefix##_set_allocator(vector, NULL)) \
+        return NULL; \
+\
+    LOG_INFO("Releasing buffer: %p of vector: %p.", (void *) vector->data, (void *) vector); \
+    T *data = vector->data; \
+    if (size) \
+        *size = vector->offset; \
+    VECTOR_STATS_ADD(vector->stats, frees, 1); \
+    VECTOR_STATS_ADD(vector->stats, bytes_freed, vector->size * sizeof(T)); \
+\
+    vector->data = NULL; \
+    vector->size = 0; \
+    vector->offset = 0; \
+    return data; \
+}
+
+#endif // VECTOR_TEMPLATE_H
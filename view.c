@@ -0,0 +1,203 @@
+#include "vector.h"
+#include "logger.h"
+#include "simd.h"
+
+#include <limits.h>
+#include <string.h>
+
+static const IntVectorView empty_int_view = { NULL, 0, 1 };
+
+IntVectorView int_vector_view(const IntVector *vector)
+{
+    return (IntVectorView) { vector->data, vector->offset, 1 };
+}
+
+IntVectorView int_vector_view_of(const int *data, size_t size)
+{
+    return (IntVectorView) { data, size, 1 };
+}
+
+IntVectorView int_vector_view_slice(IntVectorView view, size_t begin, size_t end)
+{
+    if (begin > end || end > view.size) {
+        LOG_ERROR("Range: [%li, %li) is out of bound.", begin, end);
+        return empty_int_view;
+    }
+
+    return (IntVectorView) { view.data + begin * view.stride, end - begin, view.stride };
+}
+
+IntVectorView int_vector_view_stride(IntVectorView view, size_t step)
+{
+    if (step == 0) {
+        LOG_ERROR("Step of a view can't be 0.");
+        return empty_int_view;
+    }
+
+    return (IntVectorView) { view.data, (view.size + step - 1) / step, view.stride * step };
+}
+
+int int_vector_view_get_at(IntVectorView view, size_t index)
+{
+    if (index >= view.size) {
+        LOG_ERROR("Index: %li is out of bound.", index);
+        return -1;
+    }
+    return view.data[index * view.stride];
+}
+
+// Strided views can't be loaded a register at a time, so they are walked number by number.
+long long int_vector_view_sum(IntVectorView view)
+{
+    if (view.stride == 1)
+        return simd_sum(view.data, view.size);
+
+    long long sum = 0;
+    for (size_t i = 0; i < view.size; ++i)
+        sum += view.data[i * view.stride];
+    return sum;
+}
+
+int int_vector_view_min(IntVectorView view)
+{
+    if (view.stride == 1)
+        return simd_min(view.data, view.size);
+
+    int min = INT_MAX;
+    for (size_t i = 0; i < view.size; ++i)
+        min = view.data[i * view.stride] < min ? view.data[i * view.stride] : min;
+    return min;
+}
+
+int int_vector_view_max(IntVectorView view)
+{
+    if (view.stride == 1)
+        return simd_max(view.data, view.size);
+
+    int max = INT_MIN;
+    for (size_t i = 0; i < view.size; ++i)
+        max = view.data[i * view.stride] > max ? view.data[i * view.stride] : max;
+    return max;
+}
+
+size_t int_vector_view_count(IntVectorView view, int value)
+{
+    if (view.stride == 1)
+        return simd_count(view.data, view.size, value);
+
+    size_t count = 0;
+    for (size_t i = 0; i < view.size; ++i)
+        count += view.data[i * view.stride] == value;
+    return count;
+}
+
+size_t int_vector_view_find(IntVectorView view, int value)
+{
+    if (view.stride == 1)
+        return simd_find(view.data, view.size, value);
+
+    for (size_t i = 0; i < view.size; ++i) {
+        if (view.data[i * view.stride] == value)
+            return i;
+    }
+    return -1;
+}
+
+bool int_vector_add_view(IntVector *vector, IntVectorView view)
+{
+    if (view.stride == 1)
+        return int_vector_extend(vector, view.data, view.size);
+
+    int *dest = int_vector_append_uninit(vector, view.size);
+    if (!dest)
+        return false;
+
+    for (size_t i = 0; i < view.size; ++i)
+        dest[i] = view.data[i * view.stride];
+    return true;
+}
+
+static const StringVectorView empty_string_view = { NULL, NULL, 0, 0, 1 };
+
+StringVectorView string_vector_view(const StringVector *vector)
+{
+    return (StringVectorView) { vector, NULL, 0, vector->offset, 1 };
+}
+
+StringVectorView string_vector_view_of(const char *const strings[], size_t count)
+{
+    return (StringVectorView) { NULL, strings, 0, count, 1 };
+}
+
+StringVectorView string_vector_view_slice(StringVectorView view, size_t begin, size_t end)
+{
+    if (begin > end || end > view.size) {
+        LOG_ERROR("Range: [%li, %li) is out of bound.", begin, end);
+        return empty_string_view;
+    }
+
+    view.begin += begin * view.stride;
+    view.size = end - begin;
+    return view;
+}
+
+StringVectorView string_vector_view_stride(StringVectorView view, size_t step)
+{
+    if (step == 0) {
+        LOG_ERROR("Step of a view can't be 0.");
+        return empty_string_view;
+    }
+
+    view.size = (view.size + step - 1) / step;
+    view.stride *= step;
+    return view;
+}
+
+const char *string_vector_view_get_at(StringVectorView view, size_t index)
+{
+    if (index >= view.size) {
+        LOG_ERROR("Index: %li is out of bound.", index);
+        return NULL;
+    }
+
+    size_t source = view.begin + index * view.stride;
+    return view.vector ? string_vector_get_at(view.vector, source) : view.strings[source];
+}
+
+size_t string_vector_view_get_size(StringVectorView view, size_t index)
+{
+    if (index >= view.size) {
+        LOG_ERROR("Index: %li is out of bound.", index);
+        return -1;
+    }
+
+    size_t source = view.begin + index * view.stride;
+    return view.vector ? string_vector_get_size(view.vector, source) : string_vector_strlen(view.strings[source]);
+}
+
+/* Returns the index in view of the first string equal to value, or -1 if there is none.
+ * Views of a whole indexed vector use its index, any other view is scanned. */
+size_t string_vector_view_find(StringVectorView view, const char *value)
+{
+    if (view.vector && view.vector->index && view.begin == 0 && view.stride == 1
+            && view.size == view.vector->offset)
+        return string_vector_find(view.vector, value);
+
+    if (!view.vector) {
+        for (size_t i = 0; i < view.size; ++i) {
+            if (strcmp(view.strings[view.begin + i * view.stride], value) == 0)
+                return i;
+        }
+        return -1;
+    }
+
+    // Lengths are known for strings of a vector, so most of them are skipped without reading them.
+    size_t value_size = string_vector_strlen(value);
+    for (size_t i = 0; i < view.size; ++i) {
+        size_t source = view.begin + i * view.stride;
+        if (string_vector_get_size(view.vector, source) == value_size
+                && memcmp(string_vector_get_at(view.vector, source), value, value_size) == 0)
+            return i;
+    }
+    return -1;
+}